@@ -1,8 +1,18 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
-#include <fstream>
 #include <iomanip>
+#include <memory>
+
+#include "columnar_writer.h"
+#include "metrics.h"
+#include "output_options.h"
+#include "result_cache.h"
+#include "series.h"
+#include "text_writer.h"
+#include "uncertainty.h"
+
+namespace maclaurin {
 
 /**
  * @brief Функция вычисления частичной суммы ряда Маклорена для sin(t) и exp(t).
@@ -13,71 +23,15 @@
  * 
  * Для sin(t): использует ряд t - t^3/3! + t^5/5! - ...
  * Для exp(t): использует ряд 1 + t + t^2/2! + t^3/3! + ...
+ * Суммирует в double-double, чтобы на [10,11] погрешность определялась
+ * числом слагаемых, а не взаимным уничтожением больших членов ряда.
  * Возвращает приближенное значение функции.
 */
 double maclaurin_sum(const std::string &function_type, double const t, int const n_terms) {
-    double sum = 0;
     if (function_type == "sin") {
-        // Для sin: t - t^3/3! + t^5/5! - ...
-        double term = t;
-        sum = term;
-        for (int n = 3; n <= n_terms; n += 2) {
-            term = -term * t * t / (n * (n - 1));
-            sum += term;
-        }
-    } else {
-        // exp
-        // Для exp: 1 + t + t^2/2! + t^3/3! + ...
-        double term = 1.0;
-        sum = term;
-        for (int n = 1; n <= n_terms; n++) {
-            term = term * t / n;
-            sum += term;
-        }
-    }
-    return sum;
-}
-
-/**
- * @brief Функция улучшенного алгоритма вычисления sin(t) для больших аргументов.
- *
- * @param t аргумент функции.
- * 
- * Использует периодичность sin(t): sin(t) = sin(t + 2pi k).
- * Приводит аргумент к диапазону [-pi pi] для улучшения сходимости ряда.
- * Возвращает значение sin(t) с высокой точностью.
-*/
-double improved_sin(double const t) {
-    double reduced_t = fmod(t, 2 * M_PI);
-    if (reduced_t > M_PI) {
-        reduced_t -= 2 * M_PI;
-    } else if (reduced_t < -M_PI) {
-        reduced_t += 2 * M_PI;
-    }
-    return maclaurin_sum("sin", reduced_t, 15);
-}
-
-/**
- * @brief Функция улучшенного алгоритма вычисления exp(t) для больших аргументов.
- *
- * @param t аргумент функции.
- * 
- * Использует свойство: exp(t) = exp(t/2)^2.
- * Рекурсивно уменьшает аргумент до значения <= 1.0.
- * Возвращает значение exp(t) с высокой точностью.
-*/
-double improved_exp(double t) {
-    int k = 0;
-    double reduced_t = t;
-    while (reduced_t > 1.0) {
-        reduced_t /= 2.0;
-        k++;
-    }
-    double result = maclaurin_sum("exp", reduced_t, 15);
-    for (int i = 0; i < k; i++) {
-        result *= result;
+        return numerics::maclaurin_sin_compensated(t, n_terms);
     }
-    return result;
+    return numerics::maclaurin_exp_compensated(t, n_terms);
 }
 
 /**
@@ -110,9 +64,118 @@ int find_optimal_n(const std::string &function_type, double const t, double cons
         n += (function_type == "sin") ? 2 : 1;
     }
 
+    METRICS_HISTOGRAM("maclaurin.optimal_n", n);
     return n;
 }
 
+/**
+ * @brief find_optimal_n через кэш результатов: ключ - функция, t и целевая погрешность.
+*/
+int cached_optimal_n(memo::cache &cache, const std::string &function_type, double const t, double const target_error) {
+    const memo::key key = memo::key("maclaurin.find_optimal_n").add(function_type).add(t).add(target_error);
+    return static_cast<int>(cache.get_or_compute(key, [&]() {
+        return std::vector<double>(1, find_optimal_n(function_type, t, target_error));
+    })[0]);
+}
+
+/**
+ * @brief Распространение погрешности аргумента dt через частичную сумму ряда.
+ *
+ * t ~ N(t0, dt) или равномерно на [t0 - dt, t0 + dt]; модель - пакетная частичная
+ * сумма с найденным n в double-double, как у maclaurin_sum. Возвращает {среднее,
+ * стандартное отклонение, ошибка среднего, квантили 2.5%, 50%, 97.5%} через кэш результатов.
+*/
+std::vector<double> cached_propagation(memo::cache &cache, const std::string &function_type, double const t0,
+                                       int const n_terms, numerics::distribution_kind const kind,
+                                       double const delta_t, std::size_t const samples, std::uint64_t const seed) {
+    const memo::key key = memo::key("maclaurin.propagate_uncertainty").add(function_type).add(t0).add(n_terms)
+            .add(static_cast<int>(kind)).add(delta_t).add(static_cast<long long>(samples))
+            .add(static_cast<long long>(seed));
+    return cache.get_or_compute(key, [&]() {
+        const bool is_sin = function_type == "sin";
+        const numerics::batch_model model = [is_sin, n_terms](const double *t, double *u, std::size_t count) {
+            if (is_sin) {
+                numerics::maclaurin_sin_compensated(t, u, count, n_terms);
+            } else {
+                numerics::maclaurin_exp_compensated(t, u, count, n_terms);
+            }
+        };
+        const numerics::propagation_settings settings = {samples, seed, 0, {0.025, 0.5, 0.975}};
+        const numerics::propagation_result r = numerics::propagate_uncertainty(model, {{kind, t0, delta_t}}, settings);
+        return std::vector<double>{
+            r.mean, std::sqrt(r.variance), r.mean_error(), r.quantiles[0], r.quantiles[1], r.quantiles[2]
+        };
+    });
+}
+
+/**
+ * @brief Как погрешность аргумента dt переходит в погрешность u(t).
+ *
+ * Для середин отрезков и найденных n аргумент разыгрывается методом Монте-Карло
+ * (нормальный с sigma = dt и равномерный на [t0 - dt, t0 + dt]); результат
+ * сравнивается с погрешностью обрыва ряда |u(t0) - S_n(t0)|. Пишет
+ * uncertainty_results.txt и uncertainty.bin.
+*/
+void uncertainty_study(memo::cache &cache, const output_options &options, const std::vector<int> &n_terms) {
+    METRICS_TIMER("maclaurin.uncertainty");
+    const double delta_t = 0.001;
+    const std::size_t samples = 10000000;
+    const std::uint64_t seed = 2024;
+    const char *functions[2] = {"sin", "exp"};
+    const double centers[2] = {0.5, 10.5};
+    const char *kind_names[2] = {"нормальное", "равномерное"};
+
+    text_writer file;
+    if (options.text) {
+        file.open(options.path("uncertainty_results.txt"));
+    }
+    std::unique_ptr<columnar::writer> table;
+    if (options.binary) {
+        table.reset(new columnar::writer(options.path("uncertainty.bin"), {
+                                             "function", "t", "distribution", "n_terms", "mean", "std",
+                                             "mean_error", "q025", "q500", "q975", "truncation_error"
+                                         }));
+        table->set_attribute("delta_t", delta_t);
+        table->set_attribute("samples", static_cast<double>(samples));
+        table->set_attribute("seed", static_cast<double>(seed));
+    }
+
+    file << "РАСПРОСТРАНЕНИЕ ПОГРЕШНОСТИ АРГУМЕНТА dt = " << delta_t << "\n";
+    file << "Монте-Карло: " << static_cast<long long>(samples) << " значений t на случай, seed = "
+            << static_cast<long long>(seed) << "\n";
+    file << "function\tt\tраспределение\tn\tmean\tstd\tq2.5%\tq50%\tq97.5%\tпогрешность ряда\n";
+    std::cout << "\n=== РАСПРОСТРАНЕНИЕ ПОГРЕШНОСТИ АРГУМЕНТА ===" << "\n";
+
+    for (int f = 0; f < 2; f++) {
+        for (int c = 0; c < 2; c++) {
+            const int n = n_terms[2 * c + f];
+            const double t0 = centers[c];
+            const double truncation = std::abs((f == 0 ? sin(t0) : exp(t0)) - maclaurin_sum(functions[f], t0, n));
+            for (int k = 0; k < 2; k++) {
+                const numerics::distribution_kind kind = k == 0 ? numerics::normal_distribution
+                                                                : numerics::uniform_distribution;
+                const std::vector<double> r = cached_propagation(cache, functions[f], t0, n, kind, delta_t, samples,
+                                                                 seed);
+                file << functions[f] << "\t" << t0 << "\t" << kind_names[k] << "\t" << n << "\t" << r[0] << "\t"
+                        << r[1] << "\t" << r[3] << "\t" << r[4] << "\t" << r[5] << "\t" << truncation << "\n";
+                std::cout << functions[f] << "(" << t0 << "), " << kind_names[k] << ": std u = " << r[1]
+                        << ", погрешность ряда = " << truncation << "\n";
+                if (table) {
+                    const double row[11] = {
+                        static_cast<double>(f), t0, static_cast<double>(k), static_cast<double>(n),
+                        r[0], r[1], r[2], r[3], r[4], r[5], truncation
+                    };
+                    table->append(row);
+                }
+            }
+        }
+    }
+    file.close();
+    if (table) {
+        table->close();
+    }
+}
+
 /**
  * @brief Функция анализа точности рядов Маклорена и сохранения результатов.
  * 
@@ -123,19 +186,28 @@ int find_optimal_n(const std::string &function_type, double const t, double cons
  * 
  * Сохраняет результаты для интервалов [0,1] и [10,11] в файл.
  * Выводит статистику точности в консоль.
+ *
+ * @param options какие выходные файлы писать (текст и/или бинарные таблицы).
  */
-void analyze_and_save_results() {
-    std::ofstream file("data/results.txt");
-    file << std::fixed << std::setprecision(10);
+void analyze_and_save_results(const output_options &options) {
+    METRICS_TIMER("maclaurin.run");
+    text_writer file;
+    if (options.text) {
+        file.open(options.path("results.txt"));
+    }
+    memo::cache cache;
+    if (options.cache) {
+        cache.open(options.path("cache.bin"));
+    }
 
     std::cout << "Анализ оптимального числа слагаемых в ряде Маклорена\n";
     std::cout << "Погрешность аргумента: dt = 0.001\n";
     std::cout << "==================================================\n" << "\n";
 
-    const int n_sin_01 = find_optimal_n("sin", 0.5, 0.001); // середина [0,1]
-    const int n_exp_01 = find_optimal_n("exp", 0.5, 0.001); // середина [0,1]
-    const int n_sin_1011 = find_optimal_n("sin", 10.5, 0.001); // середина [10,11]
-    const int n_exp_1011 = find_optimal_n("exp", 10.5, 0.001); // середина [10,11]
+    const int n_sin_01 = cached_optimal_n(cache, "sin", 0.5, 0.001); // середина [0,1]
+    const int n_exp_01 = cached_optimal_n(cache, "exp", 0.5, 0.001); // середина [0,1]
+    const int n_sin_1011 = cached_optimal_n(cache, "sin", 10.5, 0.001); // середина [10,11]
+    const int n_exp_1011 = cached_optimal_n(cache, "exp", 10.5, 0.001); // середина [10,11]
 
     std::cout << "ОПТИМАЛЬНЫЕ ЗНАЧЕНИЯ:\n";
     std::cout << "sin(t) на [0,1]: n = " << n_sin_01 << "\n";
@@ -149,21 +221,38 @@ void analyze_and_save_results() {
     file << "sin(t) на [10,11]: n = " << n_sin_1011 << "\n";
     file << "exp(t) на [10,11]: n = " << n_exp_1011 << "\n\n";
 
+    const std::vector<std::string> columns = {
+        "t", "sin_exact", "sin_approx", "exp_exact", "exp_approx", "sin_improved", "exp_improved"
+    };
+    std::unique_ptr<columnar::writer> table_01, table_1011;
+    if (options.binary) {
+        table_01.reset(new columnar::writer(options.path("series_01.bin"), columns));
+        table_01->set_attribute("n_sin", n_sin_01);
+        table_01->set_attribute("n_exp", n_exp_01);
+        table_1011.reset(new columnar::writer(options.path("series_1011.bin"), columns));
+        table_1011->set_attribute("n_sin", n_sin_1011);
+        table_1011->set_attribute("n_exp", n_exp_1011);
+    }
+
     file << "Значения функций на [0,1]:\n";
     file << "t\tsin_exact\tsin_approx\texp_exact\texp_approx\tsin_improved\texp_improved\n";
 
     for (double t = 0; t <= 1.0; t += 0.02) {
         double exact_sin = sin(t);
         double approx_sin = maclaurin_sum("sin", t, n_sin_01);
-        double improved_sin_val = improved_sin(t);
+        double improved_sin_val = numerics::improved_sin(t);
 
         double exact_exp = exp(t);
         double approx_exp = maclaurin_sum("exp", t, n_exp_01);
-        double improved_exp_val = improved_exp(t);
+        double improved_exp_val = numerics::improved_exp(t);
 
         file << t << "\t" << exact_sin << "\t" << approx_sin << "\t"
                 << exact_exp << "\t" << approx_exp << "\t"
                 << improved_sin_val << "\t" << improved_exp_val << "\n";
+        if (table_01) {
+            const double row[7] = {t, exact_sin, approx_sin, exact_exp, approx_exp, improved_sin_val, improved_exp_val};
+            table_01->append(row);
+        }
     }
 
     file << "\nЗначения функций на [10,11]:\n";
@@ -172,23 +261,31 @@ void analyze_and_save_results() {
     for (double t = 10; t <= 11; t += 0.05) {
         double exact_sin = sin(t);
         double approx_sin = maclaurin_sum("sin", t, n_sin_1011);
-        double improved_sin_val = improved_sin(t);
+        double improved_sin_val = numerics::improved_sin(t);
 
         double exact_exp = exp(t);
         double approx_exp = maclaurin_sum("exp", t, n_exp_1011);
-        double improved_exp_val = improved_exp(t);
+        double improved_exp_val = numerics::improved_exp(t);
 
         file << t << "\t" << exact_sin << "\t" << approx_sin << "\t"
                 << exact_exp << "\t" << approx_exp << "\t"
                 << improved_sin_val << "\t" << improved_exp_val << "\n";
+        if (table_1011) {
+            const double row[7] = {t, exact_sin, approx_sin, exact_exp, approx_exp, improved_sin_val, improved_exp_val};
+            table_1011->append(row);
+        }
     }
     file.close();
+    if (options.binary) {
+        table_01->close();
+        table_1011->close();
+    }
 
     std::cout << "\n=== ПРОВЕРКА ТОЧНОСТИ ===" << "\n";
     double t1 = 1.0;
     double exact_sin1 = sin(t1);
     double approx_sin1 = maclaurin_sum("sin", t1, n_sin_01);
-    double improved_sin1 = improved_sin(t1);
+    double improved_sin1 = numerics::improved_sin(t1);
 
     std::cout << "\nДля t = 1.0:" << "\n";
     std::cout << "sin(1.0): точное = " << exact_sin1 << ", приближение = " << approx_sin1
@@ -197,7 +294,7 @@ void analyze_and_save_results() {
 
     double exact_exp1 = exp(t1);
     double approx_exp1 = maclaurin_sum("exp", t1, n_exp_01);
-    double improved_exp1 = improved_exp(t1);
+    double improved_exp1 = numerics::improved_exp(t1);
     std::cout << "exp(1.0): точное = " << exact_exp1 << ", приближение = " << approx_exp1
             << ", улучшенное = " << improved_exp1 << "\n";
     std::cout << "погрешность = " << abs(exact_exp1 - approx_exp1) << "\n";
@@ -206,7 +303,7 @@ void analyze_and_save_results() {
     double t2 = 10.5;
     double exact_sin2 = sin(t2);
     double approx_sin2 = maclaurin_sum("sin", t2, n_sin_1011);
-    double improved_sin2 = improved_sin(t2);
+    double improved_sin2 = numerics::improved_sin(t2);
 
     std::cout << "\nДля t = 10.5:" << "\n";
     std::cout << "sin(10.5): точное = " << exact_sin2 << ", приближение = " << approx_sin2
@@ -215,18 +312,25 @@ void analyze_and_save_results() {
 
     double exact_exp2 = exp(t2);
     double approx_exp2 = maclaurin_sum("exp", t2, n_exp_1011);
-    double improved_exp2 = improved_exp(t2);
+    double improved_exp2 = numerics::improved_exp(t2);
     std::cout << "exp(10.5): точное = " << exact_exp2 << ", приближение = " << approx_exp2
             << ", улучшенное = " << improved_exp2 << "\n";
     std::cout << "погрешность = " << abs(exact_exp2 - approx_exp2) << "\n";
+
+    uncertainty_study(cache, options, {n_sin_01, n_exp_01, n_sin_1011, n_exp_1011});
 }
 
-int main() {
+/**
+ * @brief Анализ рядов Маклорена и запись результатов.
+ *
+ * @param options какие файлы писать и в какой каталог.
+*/
+int run(const output_options &options) {
     std::cout << "==============================================" << "\n";
     std::cout << "Анализ ряда Маклорена для sin(t) и exp(t)" << "\n";
     std::cout << "==============================================" << "\n";
 
-    analyze_and_save_results();
+    analyze_and_save_results(options);
 
     std::cout << "\n==============================================" << "\n";
     std::cout << "Результаты сохранены в файл: results.txt" << "\n";
@@ -235,3 +339,11 @@ int main() {
 
     return 0;
 }
+
+} // namespace maclaurin
+
+#ifndef DATA_GENERATOR_NO_MAIN
+int main(int argc, char **argv) {
+    return maclaurin::run(parse_output_options(argc, argv));
+}
+#endif
@@ -1,7 +1,18 @@
 #include <iostream>
 #include <cmath>
 #include <iomanip>
-#include <fstream>
+#include <vector>
+
+#include "autodiff.h"
+#include "columnar_writer.h"
+#include "fixed_point.h"
+#include "metrics.h"
+#include "output_options.h"
+#include "roots.h"
+#include "sampling.h"
+#include "text_writer.h"
+
+namespace half_maximum {
 
 /**
  * @brief Требуемая точность вычислений.
@@ -23,6 +34,34 @@ double f(const double x) {
     return x * exp(-x * x);
 }
 
+/**
+ * @brief Итерационная функция левой ветви: g(x) = t * exp(x^2).
+ *
+ * Шаблон, чтобы |g'(x)| в найденной точке получить автоматическим
+ * дифференцированием (numerics::dual) - условие сходимости |g'| < 1.
+*/
+template <class T>
+T g_left(const T &x, double t) {
+    return t * exp(x * x);
+}
+
+/**
+ * @brief Итерационная функция правой ветви: g(x) = sqrt(ln(x / t)).
+*/
+template <class T>
+T g_right(const T &x, double t) {
+    return sqrt(log(x / t));
+}
+
+/**
+ * @brief Коэффициент сжатия |g'(x)| итерационной функции g в точке x.
+*/
+template <class G>
+double contraction(const G &g, double x) {
+    double value;
+    return fabs(numerics::derivative(g, x, value));
+}
+
 /**
  * @brief Функция метода простой итерации для левой ветви функции.
  *
@@ -34,17 +73,9 @@ double f(const double x) {
  * Использует итерационную формулу: x = t * exp(x^2).
  * Возвращает найденный корень и количество итераций.
 */
-double simple_iteration_left(double t, double x0, int &iterarions) {
+double simple_iteration_left(double t, double x0, int &iterations) {
     // x < t
-    double x = x0;
-    iterarions = 0;
-    for (int i = 0; i < 1000; i++) {
-        iterarions++;
-        double x_new = t * exp(x * x);
-        if (fabs(x_new - x) < EPS) return x_new;
-        x = x_new;
-    }
-    return x;
+    return numerics::simple_iteration([t](double x) { return g_left(x, t); }, x0, EPS, 1000, iterations);
 }
 
 /**
@@ -60,15 +91,52 @@ double simple_iteration_left(double t, double x0, int &iterarions) {
 */
 double simple_iteration_right(double t, double x0, int &iterations) {
     // x > t
-    double x = x0;
-    iterations = 0;
-    for (int i = 0; i < 1000; i++) {
-        iterations++;
-        double x_new = sqrt(log(x / t));
-        if (fabs(x_new - x) < EPS) return x_new;
-        x = x_new;
+    return numerics::simple_iteration([t](double x) { return g_right(x, t); }, x0, EPS, 1000, iterations);
+}
+
+/**
+ * @brief Точность для сравнения ускорений: много выше EPS, чтобы была видна скорость сходимости.
+*/
+constexpr double ACCELERATION_EPS = 1e-12;
+
+/**
+ * @brief Одна ветвь, найденная одним из вариантов итераций (numerics::fixed_point).
+*/
+struct acceleration_run {
+    const char *method;
+    int branch;
+    numerics::fixed_point_result result;
+};
+
+/**
+ * @brief Обе ветви до ACCELERATION_EPS простой итерацией, методом Стеффенсена
+ * и смешиванием Андерсона (глубина истории 2).
+ *
+ * Простая итерация сходится линейно со скоростью |g'| в корне, Стеффенсен -
+ * квадратично (два вычисления g на итерацию), Андерсон - сверхлинейно
+ * с одним вычислением g на итерацию.
+*/
+std::vector<acceleration_run> acceleration_study(double t, double x0_left, double x0_right) {
+    const numerics::fixed_point_acceleration methods[3] = {
+        numerics::acceleration_none, numerics::acceleration_steffensen, numerics::acceleration_anderson
+    };
+    const char *names[3] = {"простая итерация", "Стеффенсен", "Андерсон"};
+    std::vector<acceleration_run> runs;
+    for (int branch = 0; branch < 2; branch++) {
+        for (int m = 0; m < 3; m++) {
+            numerics::fixed_point_settings settings = numerics::fixed_point_defaults(ACCELERATION_EPS);
+            settings.acceleration = methods[m];
+            settings.history = 2;
+            const acceleration_run run = {
+                names[m], branch, branch == 0
+                                      ? numerics::fixed_point([t](double x) { return g_left(x, t); }, x0_left, settings)
+                                      : numerics::fixed_point([t](double x) { return g_right(x, t); }, x0_right,
+                                                              settings)
+            };
+            runs.push_back(run);
+        }
     }
-    return x;
+    return runs;
 }
 
 /**
@@ -82,13 +150,56 @@ double simple_iteration_right(double t, double x0, int &iterations) {
  * @param fwhm ширина на полувысоте.
  * @param iter1 количество итераций для левой точки.
  * @param iter2 количество итераций для правой точки.
+ * @param runs сравнение вариантов итераций (acceleration_study).
+ * @param options какие выходные файлы писать (текст и/или бинарные таблицы).
  * 
  * Создает файл с подробными результатами вычислений
  * и данными для построения графика функции.
 */
-void save(double x_left, double x_right, double x_max, double f_max, double target, double fwhm, int iter1, int iter2) {
-    std::ofstream file("data/fwhm_results.txt");
-    file << std::fixed << std::setprecision(6);
+void save(double x_left, double x_right, double x_max, double f_max, double target, double fwhm, int iter1, int iter2,
+          const std::vector<acceleration_run> &runs, const output_options &options) {
+    // Одна адаптивная выборка для обоих файлов: гладкий горб x exp(-x^2)
+    // хорошо описывается несколькими десятками точек
+    const numerics::sampled_curve curve = numerics::adaptive_sample([](double x, double *y) {
+        y[0] = f(x);
+    }, 1, 0.0, 2.0);
+
+    if (options.binary) {
+        columnar::writer table(options.path("fwhm.bin"), {"x", "f"});
+        table.set_attribute("x_max", x_max);
+        table.set_attribute("f_max", f_max);
+        table.set_attribute("half_max", target);
+        table.set_attribute("x_left", x_left);
+        table.set_attribute("x_right", x_right);
+        table.set_attribute("fwhm", fwhm);
+        table.set_attribute("iterations_left", iter1);
+        table.set_attribute("iterations_right", iter2);
+        for (std::size_t i = 0; i < curve.size(); i++) {
+            const double row[2] = {curve.x[i], curve.y[i]};
+            table.append(row);
+        }
+        table.close();
+
+        columnar::writer acceleration(options.path("fixed_point.bin"), {
+                                          "branch", "method", "iterations", "evaluations", "x", "residual"
+                                      });
+        acceleration.set_attribute("epsilon", ACCELERATION_EPS);
+        for (std::size_t i = 0; i < runs.size(); i++) {
+            const numerics::fixed_point_result &r = runs[i].result;
+            const double row[6] = {
+                static_cast<double>(runs[i].branch), static_cast<double>(i % 3), static_cast<double>(r.iterations),
+                static_cast<double>(r.evaluations), r.x, r.residual
+            };
+            acceleration.append(row);
+        }
+        acceleration.close();
+    }
+
+    if (!options.text) {
+        return;
+    }
+
+    text_writer file(options.path("fwhm_results.txt"));
 
     file << "РЕЗУЛЬТАТЫ ВЫЧИСЛЕНИЯ ШИРИНЫ НА ПОЛУВЫСОТЕ" << "\n";
     file << "===========================================" << "\n";
@@ -111,16 +222,30 @@ void save(double x_left, double x_right, double x_max, double f_max, double targ
     file << "РЕЗУЛЬТАТ:" << "\n";
     file << "Ширина на полувысоте (FWHM) = " << fwhm << "\n" << "\n";
 
+    file << "УСКОРЕНИЕ СХОДИМОСТИ (точность " << ACCELERATION_EPS << "):" << "\n";
+    file << "Ветвь\tМетод\tИтераций\tВычислений g\tx\n";
+    for (const acceleration_run &run: runs) {
+        file << (run.branch == 0 ? "левая" : "правая") << "\t" << run.method << "\t" << run.result.iterations << "\t"
+                << run.result.evaluations << "\t" << run.result.x << "\n";
+    }
+    file << "\n";
+
     file << "ДАННЫЕ ДЛЯ ГРАФИКА:" << "\n";
     file << "x\tf(x)" << "\n";
 
-    for (double x = 0; x <= 2.0; x += 0.01) {
-        file << x << "\t" << f(x) << "\n";
+    for (std::size_t i = 0; i < curve.size(); i++) {
+        file << curve.x[i] << "\t" << curve.y[i] << "\n";
     }
     file.close();
 }
 
-int main() {
+/**
+ * @brief Вычисление ширины на полувысоте и запись результатов.
+ *
+ * @param options какие файлы писать и в какой каталог.
+*/
+int run(const output_options &options) {
+    METRICS_TIMER("half_maximum.run");
     std::cout << "ВЫЧИСЛЕНИЕ ШИРИНЫ НА ПОЛУВЫСОТЕ МЕТОДОМ ПРОСТОЙ ИТЕРАЦИИ\n";
     std::cout << "==========================================================\n\n";
 
@@ -157,9 +282,27 @@ int main() {
     std::cout << "ПРОВЕРКА ТОЧНОСТИ:\n";
     std::cout << "|f(x1) - t| = " << fabs(f(x_left) - t) << "\n";
     std::cout << "|f(x2) - t| = " << fabs(f(x_right) - t) << "\n";
+    std::cout << "|g'(x1)| = " << contraction([t](const auto &x) { return g_left(x, t); }, x_left) << "\n";
+    std::cout << "|g'(x2)| = " << contraction([t](const auto &x) { return g_right(x, t); }, x_right) << "\n";
     std::cout << "Требуемая точность: " << EPS << "\n";
 
-    save(x_left, x_right, x_max, f_max, t, fwhm, iter1, iter2);
+    const std::vector<acceleration_run> runs = acceleration_study(t, x_max - 0.2, x_max + 0.4);
+    std::cout << "\nУСКОРЕНИЕ СХОДИМОСТИ (точность " << ACCELERATION_EPS << "):\n";
+    for (const acceleration_run &run: runs) {
+        std::cout << (run.branch == 0 ? "левая" : "правая") << ", " << run.method << ": итераций "
+                << run.result.iterations << ", вычислений g " << run.result.evaluations << ", x = "
+                << std::setprecision(15) << run.result.x << std::setprecision(6) << "\n";
+    }
+
+    save(x_left, x_right, x_max, f_max, t, fwhm, iter1, iter2, runs, options);
 
     return 0;
 }
+
+} // namespace half_maximum
+
+#ifndef DATA_GENERATOR_NO_MAIN
+int main(int argc, char **argv) {
+    return half_maximum::run(parse_output_options(argc, argv));
+}
+#endif
@@ -1,8 +1,18 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <cmath>
 #include <iomanip>
+#include <memory>
+
+#include "columnar_writer.h"
+#include "interpolation.h"
+#include "metrics.h"
+#include "output_options.h"
+#include "result_cache.h"
+#include "text_writer.h"
+#include "uncertainty.h"
+
+namespace population {
 
 /**
  * @brief Структура популяция-дата.
@@ -13,86 +23,127 @@ struct population_data {
 };
 
 /**
- * @brief Функция создания таблицы разделенных разностей.
+ * @brief Таблица разделенных разностей через кэш результатов.
+ *
+ * Ключ - сами узлы и значения, таблица n x n хранится построчно.
 */
-std::vector<std::vector<double> > divided_differences(const std::vector<double> &x,
-                                                      const std::vector<double> &y) {
-    int n = x.size();
-    std::vector<std::vector<double> > diff(n, std::vector<double>(n, 0.0));
-    for (int i = 0; i < n; i++) {
-        diff[i][0] = y[i];
-    }
-    for (int j = 1; j < n; j++) {
-        for (int i = 0; i < n - j; i++) {
-            diff[i][j] = (diff[i + 1][j - 1] - diff[i][j - 1]) / (x[i + j] - x[i]);
+std::vector<std::vector<double> > cached_divided_differences(memo::cache &cache, const std::vector<double> &x,
+                                                             const std::vector<double> &y) {
+    const std::size_t n = x.size();
+    const memo::key key = memo::key("population.divided_differences").add(x).add(y);
+    const std::vector<double> flat = cache.get_or_compute(key, [&]() {
+        std::vector<double> table;
+        for (const std::vector<double> &row: numerics::divided_differences(x, y)) {
+            table.insert(table.end(), row.begin(), row.end());
         }
+        return table;
+    });
+
+    std::vector<std::vector<double> > diff(n);
+    for (std::size_t i = 0; i < n; i++) {
+        diff[i].assign(flat.begin() + i * n, flat.begin() + (i + 1) * n);
     }
     return diff;
 }
 
 /**
- * @brief Интерполяционный полином Ньютона.
+ * @brief Распределение прогноза на 2010 год при случайной погрешности переписей.
  *
- * @param x_point точка, в которой вычисляем полином.
- * @param x вектор годов.
- * @param diff таблица разделенных разностей.
- *
- * n - количество точек(годов).
- *
- * product накапливает произведение $(x - x_0)\cdot(x-x1)\cdot...$.
- *
- * result - значение полинома в точке x_point.
+ * Каждое значение населения - нормальное с sigma = relative_error * значение.
+ * method: 0 - полином Ньютона, 1 - линейный сплайн. Возвращает {среднее,
+ * стандартное отклонение, квантили 2.5%, 50%, 97.5%} через кэш результатов.
 */
-double newton_interpolation(double x_point, const std::vector<double> &x,
-                            const std::vector<std::vector<double> > &diff) {
-    int n = x.size();
-    double result = diff[0][0];
-    double product = 1.0;
-    for (int i = 1; i < n; i++) {
-        product *= (x_point - x[i - 1]);
-        result += diff[0][i] * product;
-    }
-    return result;
+std::vector<double> cached_propagation(memo::cache &cache, const std::vector<double> &years,
+                                       const std::vector<double> &population, int const method,
+                                       double const relative_error, std::size_t const samples,
+                                       std::uint64_t const seed) {
+    const memo::key key = memo::key("population.propagate_uncertainty").add(years).add(population).add(method)
+            .add(relative_error).add(static_cast<long long>(samples)).add(static_cast<long long>(seed));
+    return cache.get_or_compute(key, [&]() {
+        std::vector<numerics::uncertain_input> inputs;
+        for (const double p: population) {
+            inputs.push_back({numerics::normal_distribution, p, relative_error * p});
+        }
+        const std::size_t n = years.size();
+        numerics::batch_model model;
+        if (method == 0) {
+            model = [&years](const double *y, double *out, std::size_t count) {
+                numerics::newton_interpolation(2010, years, y, out, count);
+            };
+        } else {
+            model = [&years, n](const double *y, double *out, std::size_t count) {
+                std::vector<double> values(n);
+                for (std::size_t i = 0; i < count; i++) {
+                    for (std::size_t j = 0; j < n; j++) {
+                        values[j] = y[j * count + i];
+                    }
+                    out[i] = numerics::linear_spline(2010, years, values);
+                }
+            };
+        }
+        const numerics::propagation_settings settings = {samples, seed, 0, {0.025, 0.5, 0.975}};
+        const numerics::propagation_result r = numerics::propagate_uncertainty(model, inputs, settings);
+        return std::vector<double>{r.mean, std::sqrt(r.variance), r.quantiles[0], r.quantiles[1], r.quantiles[2]};
+    });
 }
 
 /**
- * @brief Линейная сплайн-интерполяция.
- *
- * @param x_point точка, в которой вычисляем значение.
- * @param x вектор годов.
- * @param y вектор значений населения.
- *
- * n - количество точек данных.
- *
- * interval - индекс интервала, в котором находится x_point.
- * Если x_point выходит за пределы данных, используется последний интервал для экстраполяции.
- *
- * result - вычисленное значение по линейной интерполяции/экстраполяции.
- * Формула: y_i + (y_{i+1} - y_i) * (x - x_i) / (x_{i+1} - x_i)
- *
- * Принцип работы:
- * - Для интерполяции (x_point между точками): используется линейная интерполяция на найденном интервале
- * - Для экстраполяции (x_point за пределами): продолжается наклон последнего интервала
- * - Метод устойчив и не склонен к "выстреливанию" как полиномы высокой степени
+ * @brief Чувствительность прогнозов к погрешности переписей: пишет
+ * uncertainty_results.txt и uncertainty.bin.
 */
-double linear_spline(double x_point, const std::vector<double> &x, const std::vector<double> &y) {
-    int n = x.size();
-    int interval = 0;
-    for (int i = 0; i < n - 1; i++) {
-        if (x_point >= x[i] && x_point <= x[i + 1]) {
-            interval = i;
-            break;
+void uncertainty_study(memo::cache &cache, const output_options &options, const std::vector<double> &years,
+                       const std::vector<double> &population, double const actual_2010) {
+    METRICS_TIMER("population.uncertainty");
+    const double relative_error = 0.01;
+    const std::size_t samples = 1000000;
+    const std::uint64_t seed = 2024;
+    const char *names[2] = {"Полином Ньютона", "Линейный сплайн"};
+
+    text_writer file;
+    if (options.text) {
+        file.open(options.path("uncertainty_results.txt"));
+        file.set_float_format(text_writer::fixed, 0);
+    }
+    std::unique_ptr<columnar::writer> table;
+    if (options.binary) {
+        table.reset(new columnar::writer(options.path("uncertainty.bin"),
+                                         {"method", "mean", "std", "q025", "q500", "q975"}));
+        table->set_attribute("relative_error", relative_error);
+        table->set_attribute("samples", static_cast<double>(samples));
+        table->set_attribute("seed", static_cast<double>(seed));
+        table->set_attribute("actual_2010", actual_2010);
+    }
+
+    file << "ПОГРЕШНОСТЬ ПРОГНОЗА НА 2010 ГОД\n";
+    file << "Население в каждой переписи - нормальное, sigma = 1% значения; "
+            << static_cast<long long>(samples) << " наборов, seed = " << static_cast<long long>(seed) << "\n";
+    file << "Точное значение: " << actual_2010 << "\n";
+    file << "Метод\tmean\tstd\tq2.5%\tq50%\tq97.5%\n";
+    std::cout << "\nПОГРЕШНОСТЬ ПРОГНОЗА ПРИ ПОГРЕШНОСТИ ПЕРЕПИСЕЙ 1%:" << std::endl;
+    for (int method = 0; method < 2; method++) {
+        const std::vector<double> r = cached_propagation(cache, years, population, method, relative_error, samples,
+                                                         seed);
+        file << names[method] << "\t" << r[0] << "\t" << r[1] << "\t" << r[2] << "\t" << r[3] << "\t" << r[4] << "\n";
+        std::cout << "   " << names[method] << ": " << std::setprecision(0) << r[0] << " +- " << r[1]
+                << " (95%: " << r[2] << " .. " << r[4] << ")" << std::endl;
+        if (table) {
+            const double row[6] = {static_cast<double>(method), r[0], r[1], r[2], r[3], r[4]};
+            table->append(row);
         }
     }
-    if (x_point > x[n - 1]) {
-        interval = n - 2;
+    file.close();
+    if (table) {
+        table->close();
     }
-    double result = y[interval] + (y[interval + 1] - y[interval]) * (x_point - x[interval]) / (
-                        x[interval + 1] - x[interval]);
-    return result;
 }
 
-int main() {
+/**
+ * @brief Экстраполяция населения на 2010 год и запись результатов.
+ *
+ * @param options какие файлы писать и в какой каталог.
+*/
+int run(const output_options &options) {
+    METRICS_TIMER("population.run");
     std::vector<population_data> data = {
         {1910, 92228496},
         {1920, 106021537},
@@ -114,10 +165,14 @@ int main() {
         population.push_back(entry.population);
     }
 
-    auto diff = divided_differences(years, population);
+    memo::cache cache;
+    if (options.cache) {
+        cache.open(options.path("cache.bin"));
+    }
+    auto diff = cached_divided_differences(cache, years, population);
 
-    double newton_2010 = newton_interpolation(2010, years, diff);
-    double spline_2010 = linear_spline(2010, years, population);
+    double newton_2010 = numerics::newton_interpolation(2010, years, diff);
+    double spline_2010 = numerics::linear_spline(2010, years, population);
 
     double newton_error = abs(newton_2010 - actual_2010);
     double spline_error = abs(spline_2010 - actual_2010);
@@ -148,44 +203,86 @@ int main() {
             <<
             std::endl;
 
-    std::ofstream outfile("data/results.txt");
-    outfile << std::fixed << std::setprecision(0);
-    outfile << "ИСХОДНЫЕ ДАННЫЕ:" << std::endl;
+    uncertainty_study(cache, options, years, population, actual_2010);
+
+    if (options.binary) {
+        columnar::writer original(options.path("population.bin"), {"year", "population"});
+        original.set_attribute("newton_2010", newton_2010);
+        original.set_attribute("spline_2010", spline_2010);
+        original.set_attribute("actual_2010", actual_2010);
+        original.set_attribute("newton_error", newton_error);
+        original.set_attribute("spline_error", spline_error);
+        for (const auto &entry: data) {
+            const double row[2] = {static_cast<double>(entry.year), entry.population};
+            original.append(row);
+        }
+        original.close();
+
+        columnar::writer newton(options.path("newton.bin"), {"year", "population"});
+        for (int year = 1910; year <= 2010; year++) {
+            const double row[2] = {static_cast<double>(year), numerics::newton_interpolation(year, years, diff)};
+            newton.append(row);
+        }
+        newton.close();
+
+        columnar::writer spline(options.path("spline.bin"), {"year", "population"});
+        for (int year = 1910; year <= 2010; year += 5) {
+            const double row[2] = {static_cast<double>(year), numerics::linear_spline(year, years, population)};
+            spline.append(row);
+        }
+        spline.close();
+    }
+
+    if (!options.text) {
+        return 0;
+    }
+
+    text_writer outfile(options.path("results.txt"));
+    outfile.set_float_format(text_writer::fixed, 0);
+    outfile << "ИСХОДНЫЕ ДАННЫЕ:" << "\n";
     for (const auto &entry: data) {
-        outfile << entry.year << "\t" << entry.population << std::endl;
+        outfile << entry.year << "\t" << entry.population << "\n";
     }
-    outfile << "2010\t" << actual_2010 << "\t# Точное значение" << std::endl;
+    outfile << "2010\t" << actual_2010 << "\t# Точное значение" << "\n";
 
-    outfile << "РЕЗУЛЬТАТЫ ЭКСТРАПОЛЯЦИИ:" << std::endl;
-    outfile << "newton_2010 = " << newton_2010 << std::endl;
-    outfile << "spline_2010 = " << spline_2010 << std::endl;
-    outfile << "actual_2010 = " << actual_2010 << std::endl;
-    outfile << "newton_error = " << newton_error << std::endl;
-    outfile << "spline_error = " << spline_error << std::endl;
+    outfile << "РЕЗУЛЬТАТЫ ЭКСТРАПОЛЯЦИИ:" << "\n";
+    outfile << "newton_2010 = " << newton_2010 << "\n";
+    outfile << "spline_2010 = " << spline_2010 << "\n";
+    outfile << "actual_2010 = " << actual_2010 << "\n";
+    outfile << "newton_error = " << newton_error << "\n";
+    outfile << "spline_error = " << spline_error << "\n";
 
-    outfile << "ДАННЫЕ ДЛЯ ГРАФИКА:" << std::endl;
-    outfile << "Год\tНаселение\tТип" << std::endl;
+    outfile << "ДАННЫЕ ДЛЯ ГРАФИКА:" << "\n";
+    outfile << "Год\tНаселение\tТип" << "\n";
 
-    outfile << "исходные" << std::endl;
+    outfile << "исходные" << "\n";
     for (const auto &entry: data) {
         outfile << entry.year << "\t" << entry.population << "\n";
     }
 
     outfile << "точное\n";
-    outfile << 2010 << "\t" << actual_2010 << std::endl;
+    outfile << 2010 << "\t" << actual_2010 << "\n";
 
-    outfile << "ньютон" << std::endl;
+    outfile << "ньютон" << "\n";
     for (int year = 1910; year <= 2010; year ++) {
-        double newton_val = newton_interpolation(year, years, diff);
+        double newton_val = numerics::newton_interpolation(year, years, diff);
         outfile << year << "\t" << newton_val << "\n";
     }
 
-    outfile << "сплайн" << std::endl;
+    outfile << "сплайн" << "\n";
     for (int year = 1910; year <= 2010; year += 5) {
-        double spline_val = linear_spline(year, years, population);
+        double spline_val = numerics::linear_spline(year, years, population);
         outfile << year << "\t" << spline_val << "\n";
     }
     outfile.close();
 
     return 0;
 }
+
+} // namespace population
+
+#ifndef DATA_GENERATOR_NO_MAIN
+int main(int argc, char **argv) {
+    return population::run(parse_output_options(argc, argv));
+}
+#endif
@@ -0,0 +1,301 @@
+#ifndef COLUMNAR_WRITER_H
+#define COLUMNAR_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Бинарный колоночный формат для данных графиков.
+ *
+ * Файл состоит из заголовка и блоков строк:
+ *
+ *     magic          8 байт "CMCOLS\0\1" (версия 1)
+ *     column_count   uint32
+ *     attr_count     uint32
+ *     columns        column_count раз: uint32 длина имени, имя в UTF-8, uint32 тип (0 = float64)
+ *     attributes     attr_count раз: uint32 длина ключа, ключ в UTF-8, float64 значение
+ *     blocks         uint64 rows, затем rows значений float64 первой колонки,
+ *                    rows значений второй колонки и т.д.
+ *     terminator     uint64 0
+ *
+ * Все числа записываются в little-endian. Атрибуты хранят скалярные
+ * результаты (оптимальное n, найденные корни и т.п.) рядом с таблицей.
+*/
+namespace columnar {
+
+const char magic[8] = {'C', 'M', 'C', 'O', 'L', 'S', '\0', '\1'};
+const std::uint32_t type_float64 = 0;
+
+inline bool host_is_little_endian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+/**
+ * @brief Перестановка байтов на big-endian машинах, на little-endian - копирование.
+*/
+inline void to_little_endian(void *data, const std::size_t item_size, const std::size_t count) {
+    if (host_is_little_endian()) {
+        return;
+    }
+    unsigned char *bytes = static_cast<unsigned char *>(data);
+    for (std::size_t i = 0; i < count; i++) {
+        unsigned char *item = bytes + i * item_size;
+        for (std::size_t j = 0; j < item_size / 2; j++) {
+            unsigned char tmp = item[j];
+            item[j] = item[item_size - 1 - j];
+            item[item_size - 1 - j] = tmp;
+        }
+    }
+}
+
+/**
+ * @brief Запись таблицы double-колонок в бинарный колоночный файл.
+ *
+ * Строки накапливаются в буфере по колонкам (block_rows строк) и
+ * сбрасываются в файл одним fwrite на блок. Заголовок пишется при
+ * первом сбросе, поэтому атрибуты нужно задать до записи первого блока.
+ *
+ * Ошибки открытия и записи файла выбрасываются как std::runtime_error.
+*/
+class writer {
+public:
+    writer(const std::string &path, const std::vector<std::string> &columns,
+           const std::size_t block_rows = 1 << 16)
+        : path_(path), columns_(columns), block_rows_(block_rows), rows_in_block_(0),
+          header_written_(false), file_(std::fopen(path.c_str(), "wb")) {
+        if (file_ == NULL) {
+            throw std::runtime_error("не удалось открыть файл " + path);
+        }
+        if (columns_.empty() || block_rows_ == 0) {
+            std::fclose(file_);
+            throw std::runtime_error("пустая таблица " + path);
+        }
+        buffer_.resize(columns_.size() * block_rows_);
+    }
+
+    ~writer() {
+        if (file_ != NULL) {
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+    }
+
+    /**
+     * @brief Скалярный атрибут таблицы, например "fwhm" или "n_sin_01".
+    */
+    void set_attribute(const std::string &key, const double value) {
+        if (header_written_) {
+            throw std::runtime_error("атрибуты задаются до записи данных: " + path_);
+        }
+        attribute_keys_.push_back(key);
+        attribute_values_.push_back(value);
+    }
+
+    /**
+     * @brief Добавление строки из columns.size() значений.
+    */
+    void append(const double *row) {
+        for (std::size_t c = 0; c < columns_.size(); c++) {
+            buffer_[c * block_rows_ + rows_in_block_] = row[c];
+        }
+        if (++rows_in_block_ == block_rows_) {
+            flush_block();
+        }
+    }
+
+    void append(const std::vector<double> &row) {
+        if (row.size() != columns_.size()) {
+            throw std::runtime_error("неверное число колонок в строке: " + path_);
+        }
+        append(row.data());
+    }
+
+    /**
+     * @brief Сброс остатка буфера, запись терминатора и закрытие файла.
+    */
+    void close() {
+        if (file_ == NULL) {
+            return;
+        }
+        flush_block();
+        write_u64(0);
+        const bool failed = std::fclose(file_) != 0;
+        file_ = NULL;
+        if (failed) {
+            throw std::runtime_error("ошибка записи файла " + path_);
+        }
+    }
+
+private:
+    writer(const writer &);
+    writer &operator=(const writer &);
+
+    void write_bytes(const void *data, const std::size_t size) {
+        if (size != 0 && std::fwrite(data, 1, size, file_) != size) {
+            throw std::runtime_error("ошибка записи файла " + path_);
+        }
+    }
+
+    void write_u32(std::uint32_t value) {
+        to_little_endian(&value, sizeof(value), 1);
+        write_bytes(&value, sizeof(value));
+    }
+
+    void write_u64(std::uint64_t value) {
+        to_little_endian(&value, sizeof(value), 1);
+        write_bytes(&value, sizeof(value));
+    }
+
+    void write_string(const std::string &s) {
+        write_u32(static_cast<std::uint32_t>(s.size()));
+        write_bytes(s.data(), s.size());
+    }
+
+    void write_header() {
+        write_bytes(magic, sizeof(magic));
+        write_u32(static_cast<std::uint32_t>(columns_.size()));
+        write_u32(static_cast<std::uint32_t>(attribute_keys_.size()));
+        for (std::size_t c = 0; c < columns_.size(); c++) {
+            write_string(columns_[c]);
+            write_u32(type_float64);
+        }
+        for (std::size_t a = 0; a < attribute_keys_.size(); a++) {
+            write_string(attribute_keys_[a]);
+            double value = attribute_values_[a];
+            to_little_endian(&value, sizeof(value), 1);
+            write_bytes(&value, sizeof(value));
+        }
+        header_written_ = true;
+    }
+
+    void flush_block() {
+        if (!header_written_) {
+            write_header();
+        }
+        if (rows_in_block_ == 0) {
+            return;
+        }
+        write_u64(rows_in_block_);
+        for (std::size_t c = 0; c < columns_.size(); c++) {
+            double *column = &buffer_[c * block_rows_];
+            to_little_endian(column, sizeof(double), rows_in_block_);
+            write_bytes(column, rows_in_block_ * sizeof(double));
+        }
+        rows_in_block_ = 0;
+    }
+
+    std::string path_;
+    std::vector<std::string> columns_;
+    std::vector<std::string> attribute_keys_;
+    std::vector<double> attribute_values_;
+    std::vector<double> buffer_;
+    std::size_t block_rows_;
+    std::size_t rows_in_block_;
+    bool header_written_;
+    std::FILE *file_;
+};
+
+/**
+ * @brief Прочитанная целиком таблица: имена колонок, атрибуты и данные по колонкам.
+*/
+struct table {
+    std::vector<std::string> columns;
+    std::vector<std::string> attribute_keys;
+    std::vector<double> attribute_values;
+    std::vector<std::vector<double> > data;
+};
+
+/**
+ * @brief Чтение бинарного колоночного файла, записанного columnar::writer.
+*/
+inline table read(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        throw std::runtime_error("не удалось открыть файл " + path);
+    }
+
+    struct reader {
+        std::FILE *file;
+        std::string path;
+
+        void bytes(void *data, const std::size_t size) {
+            if (size != 0 && std::fread(data, 1, size, file) != size) {
+                std::fclose(file);
+                throw std::runtime_error("файл поврежден: " + path);
+            }
+        }
+
+        std::uint32_t u32() {
+            std::uint32_t v;
+            bytes(&v, sizeof(v));
+            to_little_endian(&v, sizeof(v), 1);
+            return v;
+        }
+
+        std::uint64_t u64() {
+            std::uint64_t v;
+            bytes(&v, sizeof(v));
+            to_little_endian(&v, sizeof(v), 1);
+            return v;
+        }
+
+        std::string str() {
+            std::string s(u32(), '\0');
+            if (!s.empty()) {
+                bytes(&s[0], s.size());
+            }
+            return s;
+        }
+    } in = {file, path};
+
+    char header[sizeof(magic)];
+    in.bytes(header, sizeof(header));
+    if (std::memcmp(header, magic, sizeof(magic)) != 0) {
+        std::fclose(file);
+        throw std::runtime_error("неизвестный формат файла " + path);
+    }
+
+    table t;
+    const std::uint32_t column_count = in.u32();
+    const std::uint32_t attr_count = in.u32();
+    for (std::uint32_t c = 0; c < column_count; c++) {
+        t.columns.push_back(in.str());
+        if (in.u32() != type_float64) {
+            std::fclose(file);
+            throw std::runtime_error("неподдерживаемый тип колонки в " + path);
+        }
+    }
+    for (std::uint32_t a = 0; a < attr_count; a++) {
+        t.attribute_keys.push_back(in.str());
+        double value;
+        in.bytes(&value, sizeof(value));
+        to_little_endian(&value, sizeof(value), 1);
+        t.attribute_values.push_back(value);
+    }
+
+    t.data.resize(column_count);
+    for (std::uint64_t rows = in.u64(); rows != 0; rows = in.u64()) {
+        for (std::uint32_t c = 0; c < column_count; c++) {
+            std::vector<double> &column = t.data[c];
+            const std::size_t offset = column.size();
+            column.resize(offset + rows);
+            in.bytes(&column[offset], rows * sizeof(double));
+            to_little_endian(&column[offset], sizeof(double), rows);
+        }
+    }
+    std::fclose(file);
+    return t;
+}
+
+} // namespace columnar
+
+#endif
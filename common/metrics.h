@@ -0,0 +1,489 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+/**
+ * @brief Счетчики, таймеры и гистограммы горячих участков решателей.
+ *
+ * Макросы:
+ *
+ *     METRICS_COUNT(name)             счетчик name += 1
+ *     METRICS_ADD(name, n)            счетчик name += n
+ *     METRICS_TIMER(name)             время до конца текущего блока (RAII)
+ *     METRICS_HISTOGRAM(name, value)  значение в гистограмму name (корзины по степеням двойки)
+ *
+ * Без макроса METRICS_ENABLED все макросы раскрываются в ((void)0) и
+ * аргументы не вычисляются: в обычной сборке инструментирования нет вообще.
+ *
+ * Каждый поток пишет в свой набор ячеек без блокировок; идентификатор
+ * метрики находится по имени один раз на место вызова (статическая
+ * переменная). При завершении программы, если задана переменная окружения
+ * METRICS_OUTPUT, снимок всех потоков пишется в этот файл: в формате
+ * Prometheus, если имя оканчивается на .prom, иначе в JSON.
+*/
+
+#ifdef METRICS_ENABLED
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+constexpr std::size_t max_counters = 128;
+constexpr std::size_t max_timers = 64;
+constexpr std::size_t max_histograms = 32;
+
+/**
+ * @brief Корзина b > 0 гистограммы содержит значения из [2^(b-65), 2^(b-64)),
+ * крайние корзины собирают все, что меньше или больше. В корзину 0 попадают
+ * нули, отрицательные значения и NaN.
+*/
+constexpr int histogram_buckets = 128;
+
+inline int bucket_of(const double value) {
+    if (!(value > 0.0)) {
+        return 0;
+    }
+    if (std::isinf(value)) {
+        return histogram_buckets - 1;
+    }
+    int exponent;
+    std::frexp(value, &exponent);
+    const int b = exponent + 64;
+    return b < 1 ? 1 : (b >= histogram_buckets ? histogram_buckets - 1 : b);
+}
+
+/**
+ * @brief Верхняя граница корзины b (для b = 0 - ноль).
+*/
+inline double bucket_upper_bound(const int b) {
+    return b == 0 ? 0.0 : std::ldexp(1.0, b - 64);
+}
+
+/**
+ * @brief Ячейки одного потока. Пишет только поток-владелец (relaxed
+ * load + store без атомарного RMW), снимок читает их из другого потока.
+*/
+struct thread_data {
+    std::atomic<std::uint64_t> counters[max_counters];
+    std::atomic<std::uint64_t> timer_calls[max_timers];
+    std::atomic<std::uint64_t> timer_nanoseconds[max_timers];
+    std::atomic<std::uint64_t> histogram_counts[max_histograms][histogram_buckets];
+    std::atomic<double> histogram_sums[max_histograms];
+    std::atomic<double> histogram_min[max_histograms];
+    std::atomic<double> histogram_max[max_histograms];
+};
+
+inline void bump(std::atomic<std::uint64_t> &cell, const std::uint64_t n) {
+    cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Итоговые значения всех метрик, собранные из всех потоков.
+*/
+struct snapshot {
+    struct histogram {
+        std::string name;
+        std::uint64_t count;
+        double sum;
+        double min;
+        double max;
+        std::vector<std::uint64_t> buckets;
+    };
+
+    std::vector<std::string> counter_names;
+    std::vector<std::uint64_t> counters;
+    std::vector<std::string> timer_names;
+    std::vector<std::uint64_t> timer_calls;
+    std::vector<double> timer_seconds;
+    std::vector<histogram> histograms;
+};
+
+inline void write_at_exit();
+
+/**
+ * @brief Имена метрик и данные всех потоков, включая завершившиеся.
+*/
+class registry {
+public:
+    static registry &instance() {
+        static registry r;
+        return r;
+    }
+
+    std::size_t counter_id(const char *name) {
+        return register_name(counter_names_, name, max_counters);
+    }
+
+    std::size_t timer_id(const char *name) {
+        return register_name(timer_names_, name, max_timers);
+    }
+
+    std::size_t histogram_id(const char *name) {
+        return register_name(histogram_names_, name, max_histograms);
+    }
+
+    thread_data *attach() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread_data *data = new thread_data();
+        clear(*data);
+        threads_.push_back(data);
+        return data;
+    }
+
+    /**
+     * @brief Перенос данных завершившегося потока в общий итог.
+    */
+    void detach(thread_data *data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        merge(*data, retired_);
+        for (std::size_t i = 0; i < threads_.size(); i++) {
+            if (threads_[i] == data) {
+                threads_.erase(threads_.begin() + static_cast<long>(i));
+                break;
+            }
+        }
+        delete data;
+    }
+
+    snapshot take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread_data total;
+        clear(total);
+        merge(retired_, total);
+        for (thread_data *data: threads_) {
+            merge(*data, total);
+        }
+
+        snapshot s;
+        s.counter_names = counter_names_;
+        for (std::size_t i = 0; i < counter_names_.size(); i++) {
+            s.counters.push_back(total.counters[i].load(std::memory_order_relaxed));
+        }
+        s.timer_names = timer_names_;
+        for (std::size_t i = 0; i < timer_names_.size(); i++) {
+            s.timer_calls.push_back(total.timer_calls[i].load(std::memory_order_relaxed));
+            s.timer_seconds.push_back(1e-9 * static_cast<double>(total.timer_nanoseconds[i].load(std::memory_order_relaxed)));
+        }
+        for (std::size_t i = 0; i < histogram_names_.size(); i++) {
+            snapshot::histogram h;
+            h.name = histogram_names_[i];
+            h.count = 0;
+            for (int b = 0; b < histogram_buckets; b++) {
+                h.buckets.push_back(total.histogram_counts[i][b].load(std::memory_order_relaxed));
+                h.count += h.buckets.back();
+            }
+            h.sum = total.histogram_sums[i].load(std::memory_order_relaxed);
+            h.min = total.histogram_min[i].load(std::memory_order_relaxed);
+            h.max = total.histogram_max[i].load(std::memory_order_relaxed);
+            s.histograms.push_back(h);
+        }
+        return s;
+    }
+
+private:
+    registry()
+        : exit_hook_(false) {
+        clear(retired_);
+    }
+
+    std::size_t register_name(std::vector<std::string> &names, const char *name, const std::size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!exit_hook_) {
+            std::atexit(write_at_exit);
+            exit_hook_ = true;
+        }
+        for (std::size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) {
+                return i;
+            }
+        }
+        if (names.size() == limit) {
+            throw std::runtime_error(std::string("слишком много метрик, не зарегистрирована ") + name);
+        }
+        names.push_back(name);
+        return names.size() - 1;
+    }
+
+    static void clear(thread_data &data) {
+        for (std::size_t i = 0; i < max_counters; i++) {
+            data.counters[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < max_timers; i++) {
+            data.timer_calls[i].store(0, std::memory_order_relaxed);
+            data.timer_nanoseconds[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < max_histograms; i++) {
+            for (int b = 0; b < histogram_buckets; b++) {
+                data.histogram_counts[i][b].store(0, std::memory_order_relaxed);
+            }
+            data.histogram_sums[i].store(0.0, std::memory_order_relaxed);
+            data.histogram_min[i].store(INFINITY, std::memory_order_relaxed);
+            data.histogram_max[i].store(-INFINITY, std::memory_order_relaxed);
+        }
+    }
+
+    static void merge(const thread_data &from, thread_data &to) {
+        for (std::size_t i = 0; i < max_counters; i++) {
+            bump(to.counters[i], from.counters[i].load(std::memory_order_relaxed));
+        }
+        for (std::size_t i = 0; i < max_timers; i++) {
+            bump(to.timer_calls[i], from.timer_calls[i].load(std::memory_order_relaxed));
+            bump(to.timer_nanoseconds[i], from.timer_nanoseconds[i].load(std::memory_order_relaxed));
+        }
+        for (std::size_t i = 0; i < max_histograms; i++) {
+            for (int b = 0; b < histogram_buckets; b++) {
+                bump(to.histogram_counts[i][b], from.histogram_counts[i][b].load(std::memory_order_relaxed));
+            }
+            to.histogram_sums[i].store(to.histogram_sums[i].load(std::memory_order_relaxed)
+                                       + from.histogram_sums[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.histogram_min[i].store(std::fmin(to.histogram_min[i].load(std::memory_order_relaxed),
+                                                from.histogram_min[i].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+            to.histogram_max[i].store(std::fmax(to.histogram_max[i].load(std::memory_order_relaxed),
+                                                from.histogram_max[i].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        }
+    }
+
+    std::mutex mutex_;
+    std::vector<std::string> counter_names_;
+    std::vector<std::string> timer_names_;
+    std::vector<std::string> histogram_names_;
+    std::vector<thread_data *> threads_;
+    thread_data retired_;
+    bool exit_hook_;
+};
+
+/**
+ * @brief Владелец ячеек текущего потока: создает их при первой записи и
+ * отдает в общий итог при завершении потока.
+*/
+class thread_slot {
+public:
+    thread_slot()
+        : data_(NULL) {
+    }
+
+    ~thread_slot() {
+        if (data_ != NULL) {
+            registry::instance().detach(data_);
+        }
+    }
+
+    thread_data &get() {
+        if (data_ == NULL) {
+            data_ = registry::instance().attach();
+        }
+        return *data_;
+    }
+
+private:
+    thread_data *data_;
+};
+
+inline thread_data &local() {
+    thread_local thread_slot slot;
+    return slot.get();
+}
+
+inline void add(const std::size_t id, const std::uint64_t n) {
+    bump(local().counters[id], n);
+}
+
+inline void record(const std::size_t id, const double value) {
+    thread_data &data = local();
+    bump(data.histogram_counts[id][bucket_of(value)], 1);
+    data.histogram_sums[id].store(data.histogram_sums[id].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value < data.histogram_min[id].load(std::memory_order_relaxed)) {
+        data.histogram_min[id].store(value, std::memory_order_relaxed);
+    }
+    if (value > data.histogram_max[id].load(std::memory_order_relaxed)) {
+        data.histogram_max[id].store(value, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Таймер области видимости: число вызовов и суммарное время.
+*/
+class scoped_timer {
+public:
+    explicit scoped_timer(const std::size_t id)
+        : id_(id), start_(std::chrono::steady_clock::now()) {
+    }
+
+    ~scoped_timer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        thread_data &data = local();
+        bump(data.timer_calls[id_], 1);
+        bump(data.timer_nanoseconds[id_],
+             static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    scoped_timer(const scoped_timer &) = delete;
+    scoped_timer &operator=(const scoped_timer &) = delete;
+
+private:
+    std::size_t id_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+inline std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (const char c: s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+/**
+ * @brief Число для JSON и Prometheus: бесконечности и NaN - строками, как в Prometheus.
+*/
+inline std::string number(const double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    char buffer[32];
+    const std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, r.ptr);
+}
+
+inline void write_json(std::ostream &out, const snapshot &s) {
+    out << "{\n  \"counters\": {";
+    for (std::size_t i = 0; i < s.counters.size(); i++) {
+        out << (i ? ",\n" : "\n") << "    " << json_string(s.counter_names[i]) << ": " << s.counters[i];
+    }
+    out << "\n  },\n  \"timers\": {";
+    for (std::size_t i = 0; i < s.timer_calls.size(); i++) {
+        out << (i ? ",\n" : "\n") << "    " << json_string(s.timer_names[i])
+                << ": {\"calls\": " << s.timer_calls[i] << ", \"seconds\": " << number(s.timer_seconds[i]) << "}";
+    }
+    out << "\n  },\n  \"histograms\": {";
+    for (std::size_t i = 0; i < s.histograms.size(); i++) {
+        const snapshot::histogram &h = s.histograms[i];
+        out << (i ? ",\n" : "\n") << "    " << json_string(h.name) << ": {\"count\": " << h.count;
+        if (h.count != 0) {
+            // Бесконечность и NaN в JSON не числа - пишем их строками
+            const bool finite = std::isfinite(h.sum) && std::isfinite(h.min) && std::isfinite(h.max);
+            const char *q = finite ? "" : "\"";
+            out << ", \"sum\": " << q << number(h.sum) << q
+                    << ", \"min\": " << q << number(h.min) << q
+                    << ", \"max\": " << q << number(h.max) << q;
+        }
+        out << ", \"buckets\": [";
+        bool first = true;
+        for (int b = 0; b < histogram_buckets; b++) {
+            if (h.buckets[b] != 0) {
+                out << (first ? "" : ", ") << "{\"le\": \"" << number(b == histogram_buckets - 1 ? INFINITY : bucket_upper_bound(b))
+                        << "\", \"count\": " << h.buckets[b] << "}";
+                first = false;
+            }
+        }
+        out << "]}";
+    }
+    out << "\n  }\n}\n";
+}
+
+/**
+ * @brief Имя метрики в Prometheus: префикс cm_, точки и дефисы заменены на _.
+*/
+inline std::string prometheus_name(const std::string &name) {
+    std::string out = "cm_";
+    for (const char c: name) {
+        const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        out += ok ? c : '_';
+    }
+    return out;
+}
+
+inline void write_prometheus(std::ostream &out, const snapshot &s) {
+    for (std::size_t i = 0; i < s.counters.size(); i++) {
+        const std::string name = prometheus_name(s.counter_names[i]) + "_total";
+        out << "# TYPE " << name << " counter\n" << name << " " << s.counters[i] << "\n";
+    }
+    for (std::size_t i = 0; i < s.timer_calls.size(); i++) {
+        const std::string name = prometheus_name(s.timer_names[i]);
+        out << "# TYPE " << name << "_calls_total counter\n" << name << "_calls_total " << s.timer_calls[i] << "\n";
+        out << "# TYPE " << name << "_seconds_total counter\n" << name << "_seconds_total " << number(s.timer_seconds[i]) << "\n";
+    }
+    for (const snapshot::histogram &h: s.histograms) {
+        const std::string name = prometheus_name(h.name);
+        out << "# TYPE " << name << " histogram\n";
+        std::uint64_t cumulative = 0;
+        for (int b = 0; b < histogram_buckets - 1; b++) {
+            cumulative += h.buckets[b];
+            if (h.buckets[b] != 0) {
+                out << name << "_bucket{le=\"" << number(bucket_upper_bound(b)) << "\"} " << cumulative << "\n";
+            }
+        }
+        out << name << "_bucket{le=\"+Inf\"} " << h.count << "\n";
+        out << name << "_sum " << number(h.sum) << "\n";
+        out << name << "_count " << h.count << "\n";
+    }
+}
+
+/**
+ * @brief Запись снимка в файл из METRICS_OUTPUT (вызывается через atexit).
+*/
+inline void write_at_exit() {
+    const char *path = std::getenv("METRICS_OUTPUT");
+    if (path == NULL || *path == '\0') {
+        return;
+    }
+    std::ofstream out(path);
+    const std::string p = path;
+    const snapshot s = registry::instance().take();
+    if (p.size() >= 5 && p.compare(p.size() - 5, 5, ".prom") == 0) {
+        write_prometheus(out, s);
+    } else {
+        write_json(out, s);
+    }
+}
+
+} // namespace metrics
+
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+
+#define METRICS_ADD(name, n) \
+    do { \
+        static const std::size_t metrics_id = ::metrics::registry::instance().counter_id(name); \
+        ::metrics::add(metrics_id, static_cast<std::uint64_t>(n)); \
+    } while (0)
+
+#define METRICS_COUNT(name) METRICS_ADD(name, 1)
+
+#define METRICS_HISTOGRAM(name, value) \
+    do { \
+        static const std::size_t metrics_id = ::metrics::registry::instance().histogram_id(name); \
+        ::metrics::record(metrics_id, static_cast<double>(value)); \
+    } while (0)
+
+#define METRICS_TIMER(name) \
+    static const std::size_t METRICS_CONCAT(metrics_timer_id_, __LINE__) = \
+        ::metrics::registry::instance().timer_id(name); \
+    ::metrics::scoped_timer METRICS_CONCAT(metrics_timer_, __LINE__)(METRICS_CONCAT(metrics_timer_id_, __LINE__))
+
+#else
+
+#define METRICS_ADD(name, n) ((void)0)
+#define METRICS_COUNT(name) ((void)0)
+#define METRICS_HISTOGRAM(name, value) ((void)0)
+#define METRICS_TIMER(name) ((void)0)
+
+#endif
+
+#endif
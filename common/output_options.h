@@ -0,0 +1,52 @@
+#ifndef OUTPUT_OPTIONS_H
+#define OUTPUT_OPTIONS_H
+
+#include <string>
+
+/**
+ * @brief Какие выходные файлы пишет генератор данных и куда.
+ *
+ * По умолчанию пишутся и бинарные таблицы, и текстовый results.txt
+ * (его читают C#-плоттеры) в каталог data. Флаги командной строки:
+ * --no-text отключает текстовый файл, --no-binary - бинарные таблицы,
+ * --no-cache - кэш результатов (cache.bin в каталоге вывода, см. result_cache.h),
+ * --out-dir=PATH меняет каталог вывода.
+*/
+struct output_options {
+    bool text;
+    bool binary;
+    bool cache;
+    std::string dir;
+
+    /**
+     * @brief Путь к выходному файлу name в каталоге вывода.
+    */
+    std::string path(const std::string &name) const {
+        return dir + "/" + name;
+    }
+};
+
+inline output_options default_output_options() {
+    output_options options = {true, true, true, "data"};
+    return options;
+}
+
+inline output_options parse_output_options(const int argc, char **argv) {
+    output_options options = default_output_options();
+    const std::string out_dir = "--out-dir=";
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--no-text") {
+            options.text = false;
+        } else if (arg == "--no-binary") {
+            options.binary = false;
+        } else if (arg == "--no-cache") {
+            options.cache = false;
+        } else if (arg.compare(0, out_dir.size(), out_dir) == 0) {
+            options.dir = arg.substr(out_dir.size());
+        }
+    }
+    return options;
+}
+
+#endif
@@ -0,0 +1,531 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "metrics.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Постоянный кэш результатов расчетов на диске.
+ *
+ * Результат (вектор double) адресуется ключом: имя метода, его параметры
+ * и входные данные. Записи хранятся в файле, отображенном в память (mmap),
+ * так что повторный запуск с теми же входами получает результат без расчета.
+ *
+ * Файл:
+ *
+ *     magic     8 байт "CMMEMO\0\1" (версия 1)
+ *     end       uint64 смещение конца последней записи
+ *     clock     uint64 счетчик обращений для LRU
+ *     reserved  uint64
+ *     records   uint64 hash, uint64 last_used, uint32 key_size, uint32 value_count,
+ *               байты ключа (дополненные до 8), value_count значений double
+ *
+ * Числа записываются в порядке байтов машины: кэш локален и при смене
+ * платформы просто пересоздается. Размер файла ограничен capacity байтами;
+ * когда новая запись не помещается, файл уплотняется и давно не читавшиеся
+ * записи (наименьший last_used) вытесняются.
+*/
+namespace memo {
+
+const char magic[8] = {'C', 'M', 'M', 'E', 'M', 'O', '\0', '\1'};
+
+/**
+ * @brief Отпечаток сборки: хеш FNV-1a исполняемого файла процесса (/proc/self/exe).
+ *
+ * Входит в каждый ключ, поэтому любая пересборка с изменением кода (ядер,
+ * подынтегральных функций, методов) делает старые записи недостижимыми - они
+ * вытесняются по LRU, а результаты пересчитываются. Повторная сборка того же
+ * кода дает тот же файл и сохраняет кэш. Считается один раз за процесс.
+ *
+ * @return false, если файл не прочитать (нет /proc): тогда старые записи
+ * не отличить от новых, и cache::open оставляет кэш закрытым.
+*/
+inline bool build_id(std::uint64_t &id) {
+    static const std::pair<bool, std::uint64_t> fingerprint = []() {
+        const int fd = ::open("/proc/self/exe", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return std::make_pair(false, std::uint64_t(0));
+        }
+        std::uint64_t h = 14695981039346656037ULL;
+        unsigned char buffer[1 << 16];
+        ssize_t n;
+        while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                h ^= buffer[i];
+                h *= 1099511628211ULL;
+            }
+        }
+        ::close(fd);
+        return std::make_pair(n == 0, h);
+    }();
+    id = fingerprint.second;
+    return fingerprint.first;
+}
+
+/**
+ * @brief Ключ кэша: имя метода, параметры и входные данные в одной байтовой строке.
+ *
+ * Каждое значение записывается с тегом типа (строки и векторы - с длиной),
+ * поэтому разные наборы параметров не склеиваются в одинаковые байты.
+ * Хеш FNV-1a ключа - адрес записи; при совпадении хеша байты ключа
+ * сравниваются целиком, так что коллизия не вернет чужой результат.
+ * Первым в ключ пишется отпечаток сборки build_id, так что версию метода
+ * в имени вручную менять не нужно.
+*/
+class key {
+public:
+    explicit key(const std::string &method) {
+        std::uint64_t id = 0;
+        build_id(id);
+        add(static_cast<long long>(id));
+        add(method);
+    }
+
+    key &add(const double value) {
+        bytes_.push_back('d');
+        append(&value, sizeof(value));
+        return *this;
+    }
+
+    key &add(const long long value) {
+        bytes_.push_back('i');
+        append(&value, sizeof(value));
+        return *this;
+    }
+
+    key &add(const int value) {
+        return add(static_cast<long long>(value));
+    }
+
+    key &add(const std::string &value) {
+        bytes_.push_back('s');
+        const std::uint64_t size = value.size();
+        append(&size, sizeof(size));
+        bytes_.append(value);
+        return *this;
+    }
+
+    key &add(const char *value) {
+        return add(std::string(value));
+    }
+
+    key &add(const std::vector<double> &values) {
+        bytes_.push_back('v');
+        const std::uint64_t size = values.size();
+        append(&size, sizeof(size));
+        append(values.data(), values.size() * sizeof(double));
+        return *this;
+    }
+
+    std::uint64_t hash() const {
+        std::uint64_t h = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < bytes_.size(); i++) {
+            h ^= static_cast<unsigned char>(bytes_[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    const std::string &bytes() const {
+        return bytes_;
+    }
+
+private:
+    void append(const void *data, const std::size_t size) {
+        bytes_.append(static_cast<const char *>(data), size);
+    }
+
+    std::string bytes_;
+};
+
+/**
+ * @brief Кэш результатов в файле, отображенном в память.
+ *
+ * Кэш, созданный конструктором по умолчанию, закрыт: find всегда
+ * промахивается, store ничего не делает, get_or_compute просто считает.
+ * Закрытым остается и кэш, для которого не удалось вычислить отпечаток
+ * сборки build_id: open предупреждает об этом в stderr.
+ * Пока кэш открыт, файл заблокирован (flock) от других процессов.
+ *
+ * Ошибки открытия и отображения файла выбрасываются как std::runtime_error.
+*/
+class cache {
+public:
+    cache()
+        : fd_(-1), map_(NULL), capacity_(0), hits_(0), misses_(0) {
+    }
+
+    explicit cache(const std::string &path, const std::size_t capacity = default_capacity)
+        : fd_(-1), map_(NULL), capacity_(0), hits_(0), misses_(0) {
+        open(path, capacity);
+    }
+
+    ~cache() {
+        close();
+    }
+
+    cache(const cache &) = delete;
+    cache &operator=(const cache &) = delete;
+
+    /**
+     * @brief Открытие (или создание) файла кэша.
+     *
+     * @param capacity предельный размер файла в байтах. Если существующий
+     * файл другого размера, его записи переносятся в новый, начиная с самых свежих.
+    */
+    void open(const std::string &path, std::size_t capacity = default_capacity) {
+        close();
+        std::uint64_t id;
+        if (!build_id(id)) {
+            std::cerr << "кэш " << path << " отключен: не удалось вычислить отпечаток сборки "
+                    "(/proc/self/exe), старые результаты нельзя отличить от новых\n";
+            return;
+        }
+        capacity = align(std::max(capacity, min_capacity));
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("не удалось открыть кэш " + path);
+        }
+        if (flock(fd_, LOCK_EX) != 0) {
+            fail("не удалось заблокировать кэш " + path);
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            fail("не удалось прочитать кэш " + path);
+        }
+        path_ = path;
+
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        if (size == capacity) {
+            map(capacity);
+            if (header_valid()) {
+                build_index();
+                return;
+            }
+            unmap();
+        }
+
+        // Другой размер или поврежденный заголовок: переносим то, что читается
+        std::vector<record_copy> saved;
+        std::uint64_t clock = 0;
+        if (size >= header_size) {
+            map(size);
+            if (header_valid()) {
+                clock = header()[2];
+                saved = copy_records();
+            }
+            unmap();
+        }
+
+        if (ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+            fail("не удалось изменить размер кэша " + path);
+        }
+        map(capacity);
+        std::memcpy(map_, magic, sizeof(magic));
+        header()[1] = header_size;
+        header()[2] = clock;
+        header()[3] = 0;
+        rewrite(saved, capacity_ - header_size);
+    }
+
+    bool is_open() const {
+        return map_ != NULL;
+    }
+
+    /**
+     * @brief Поиск результата по ключу.
+     *
+     * @param value найденный результат (выходной параметр).
+     * @return true, если результат есть в кэше.
+    */
+    bool find(const key &k, std::vector<double> &value) {
+        if (map_ == NULL) {
+            return false;
+        }
+        const std::size_t offset = locate(k);
+        if (offset == 0) {
+            misses_++;
+            METRICS_COUNT("cache.misses");
+            return false;
+        }
+        hits_++;
+        METRICS_COUNT("cache.hits");
+        std::uint64_t *record = at(offset);
+        record[1] = ++header()[2];
+        const std::uint32_t count = value_count(record);
+        value.resize(count);
+        std::memcpy(value.data(), values(record), count * sizeof(double));
+        return true;
+    }
+
+    /**
+     * @brief Запись результата. Прежний результат с тем же ключом заменяется.
+     *
+     * Запись больше capacity не сохраняется.
+    */
+    void store(const key &k, const std::vector<double> &value) {
+        if (map_ == NULL) {
+            return;
+        }
+        const std::size_t size = record_size(k.bytes().size(), value.size());
+        if (size > capacity_ - header_size) {
+            return;
+        }
+
+        const std::size_t existing = locate(k);
+        if (existing != 0) {
+            std::uint64_t *record = at(existing);
+            if (value_count(record) == value.size()) {
+                std::memcpy(values(record), value.data(), value.size() * sizeof(double));
+                record[1] = ++header()[2];
+                return;
+            }
+            erase(existing);
+        }
+
+        if (header()[1] + size > capacity_) {
+            // Уплотняем до 3/4 емкости, чтобы не пересобирать файл на каждой записи
+            const std::size_t budget = (capacity_ - header_size) * 3 / 4;
+            METRICS_COUNT("cache.compactions");
+            rewrite(copy_records(), budget > size ? budget - size : 0);
+        }
+
+        const std::size_t offset = header()[1];
+        std::uint64_t *record = at(offset);
+        record[0] = k.hash();
+        record[1] = ++header()[2];
+        set_sizes(record, static_cast<std::uint32_t>(k.bytes().size()), static_cast<std::uint32_t>(value.size()));
+        std::memcpy(record + 3, k.bytes().data(), k.bytes().size());
+        std::memcpy(values(record), value.data(), value.size() * sizeof(double));
+        header()[1] = offset + size;
+        index_.insert(std::make_pair(record[0], offset));
+    }
+
+    /**
+     * @brief Результат из кэша или, при промахе, compute() с сохранением в кэш.
+     *
+     * @param compute функция без аргументов, возвращающая std::vector<double>.
+    */
+    template <class Compute>
+    std::vector<double> get_or_compute(const key &k, Compute compute) {
+        std::vector<double> value;
+        if (!find(k, value)) {
+            value = compute();
+            store(k, value);
+        }
+        return value;
+    }
+
+    std::size_t hits() const {
+        return hits_;
+    }
+
+    std::size_t misses() const {
+        return misses_;
+    }
+
+    /**
+     * @brief Снятие отображения, блокировки и закрытие файла.
+    */
+    void close() {
+        unmap();
+        index_.clear();
+        if (fd_ >= 0) {
+            flock(fd_, LOCK_UN);
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    static constexpr std::size_t default_capacity = 16 << 20;
+    static constexpr std::size_t min_capacity = 4096;
+
+private:
+    static constexpr std::size_t header_size = 32;
+
+    /**
+     * @brief Запись, скопированная из файла при уплотнении: last_used и байты записи.
+    */
+    typedef std::pair<std::uint64_t, std::string> record_copy;
+
+    static std::size_t align(const std::size_t size) {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    static std::size_t record_size(const std::size_t key_size, const std::size_t count) {
+        return 24 + align(key_size) + count * sizeof(double);
+    }
+
+    static std::uint32_t key_size(const std::uint64_t *record) {
+        std::uint32_t size;
+        std::memcpy(&size, record + 2, sizeof(size));
+        return size;
+    }
+
+    static std::uint32_t value_count(const std::uint64_t *record) {
+        std::uint32_t count;
+        std::memcpy(&count, reinterpret_cast<const char *>(record + 2) + 4, sizeof(count));
+        return count;
+    }
+
+    static void set_sizes(std::uint64_t *record, const std::uint32_t key_size, const std::uint32_t count) {
+        std::memcpy(record + 2, &key_size, sizeof(key_size));
+        std::memcpy(reinterpret_cast<char *>(record + 2) + 4, &count, sizeof(count));
+    }
+
+    static double *values(std::uint64_t *record) {
+        return reinterpret_cast<double *>(reinterpret_cast<char *>(record + 3) + align(key_size(record)));
+    }
+
+    std::uint64_t *header() {
+        return static_cast<std::uint64_t *>(map_);
+    }
+
+    std::uint64_t *at(const std::size_t offset) {
+        return reinterpret_cast<std::uint64_t *>(static_cast<char *>(map_) + offset);
+    }
+
+    void fail(const std::string &message) {
+        close();
+        throw std::runtime_error(message);
+    }
+
+    void map(const std::size_t size) {
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            fail("не удалось отобразить кэш в память " + path_);
+        }
+        map_ = p;
+        capacity_ = size;
+    }
+
+    void unmap() {
+        if (map_ != NULL) {
+            munmap(map_, capacity_);
+            map_ = NULL;
+            capacity_ = 0;
+        }
+    }
+
+    bool header_valid() {
+        return std::memcmp(map_, magic, sizeof(magic)) == 0
+               && header()[1] >= header_size && header()[1] <= capacity_;
+    }
+
+    /**
+     * @brief Обход записей. Хвост, не прошедший проверку размеров (обрыв
+     * при аварийном завершении), отбрасывается.
+    */
+    template <class Visit>
+    void for_each_record(Visit visit) {
+        std::size_t offset = header_size;
+        const std::size_t end = header()[1];
+        while (offset + 24 <= end) {
+            std::uint64_t *record = at(offset);
+            const std::size_t size = record_size(key_size(record), value_count(record));
+            if (size > end - offset) {
+                break;
+            }
+            if (record[1] != 0) {
+                visit(offset, record, size);
+            }
+            offset += size;
+        }
+        header()[1] = offset;
+    }
+
+    void build_index() {
+        index_.clear();
+        for_each_record([this](const std::size_t offset, std::uint64_t *record, std::size_t) {
+            index_.insert(std::make_pair(record[0], offset));
+        });
+    }
+
+    std::vector<record_copy> copy_records() {
+        std::vector<record_copy> records;
+        for_each_record([&records](std::size_t, std::uint64_t *record, const std::size_t size) {
+            records.push_back(record_copy(record[1], std::string(reinterpret_cast<const char *>(record), size)));
+        });
+        return records;
+    }
+
+    /**
+     * @brief Перезапись файла: самые свежие записи, пока их суммарный размер не больше budget.
+    */
+    void rewrite(std::vector<record_copy> records, const std::size_t budget) {
+        std::sort(records.begin(), records.end(), [](const record_copy &lhs, const record_copy &rhs) {
+            return lhs.first > rhs.first;
+        });
+        index_.clear();
+        std::size_t offset = header_size;
+        std::size_t used = 0;
+        for (const record_copy &r: records) {
+            if (used + r.second.size() > budget) {
+                break;
+            }
+            std::memcpy(at(offset), r.second.data(), r.second.size());
+            index_.insert(std::make_pair(at(offset)[0], offset));
+            offset += r.second.size();
+            used += r.second.size();
+        }
+        header()[1] = offset;
+    }
+
+    std::size_t locate(const key &k) {
+        if (map_ == NULL) {
+            return 0;
+        }
+        const std::string &bytes = k.bytes();
+        auto range = index_.equal_range(k.hash());
+        for (auto it = range.first; it != range.second; ++it) {
+            std::uint64_t *record = at(it->second);
+            if (key_size(record) == bytes.size() && std::memcmp(record + 3, bytes.data(), bytes.size()) == 0) {
+                return it->second;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Удаление записи: last_used = 0, место освобождается при уплотнении.
+    */
+    void erase(const std::size_t offset) {
+        std::uint64_t *record = at(offset);
+        auto range = index_.equal_range(record[0]);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == offset) {
+                index_.erase(it);
+                break;
+            }
+        }
+        record[1] = 0;
+    }
+
+    std::string path_;
+    int fd_;
+    void *map_;
+    std::size_t capacity_;
+    std::unordered_multimap<std::uint64_t, std::size_t> index_;
+    std::size_t hits_;
+    std::size_t misses_;
+};
+
+} // namespace memo
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef NUMERICS_AUTODIFF_H
+#define NUMERICS_AUTODIFF_H
+
+#include <array>
+#include <cmath>
+
+namespace numerics {
+
+/**
+ * @brief Дуальное число для автоматического дифференцирования вперед.
+ *
+ * value - значение функции, grad[i] - ее производная по i-й из N
+ * независимых переменных. Функция, записанная шаблоном по типу аргумента,
+ * вычисляется с dual<N> один раз и дает значение вместе со всеми N
+ * производными - точными, без конечных разностей. Операции над grad -
+ * циклы по N дорожкам, которые компилятор векторизует.
+ *
+ * Пример: template <class T> T f(const T &x) { return x * exp(-x * x); }
+ * derivative([](const auto &x) { return f(x); }, 0.5, value).
+*/
+template <int N>
+struct dual {
+    double value;
+    double grad[N];
+};
+
+/**
+ * @brief Константа: все производные равны нулю.
+*/
+template <int N>
+dual<N> constant(const double value) {
+    dual<N> r;
+    r.value = value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = 0.0;
+    }
+    return r;
+}
+
+/**
+ * @brief Независимая переменная номер index: d/dx_index = 1.
+*/
+template <int N>
+dual<N> variable(const double value, const int index) {
+    dual<N> r = constant<N>(value);
+    r.grad[index] = 1.0;
+    return r;
+}
+
+/**
+ * @brief Цепное правило: g(a) при известных g(a.value) и g'(a.value).
+*/
+template <int N>
+dual<N> chain(const dual<N> &a, const double value, const double derivative) {
+    dual<N> r;
+    r.value = value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = derivative * a.grad[i];
+    }
+    return r;
+}
+
+template <int N>
+dual<N> operator-(const dual<N> &a) {
+    return chain(a, -a.value, -1.0);
+}
+
+template <int N>
+dual<N> operator+(const dual<N> &a, const dual<N> &b) {
+    dual<N> r;
+    r.value = a.value + b.value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = a.grad[i] + b.grad[i];
+    }
+    return r;
+}
+
+template <int N>
+dual<N> operator-(const dual<N> &a, const dual<N> &b) {
+    dual<N> r;
+    r.value = a.value - b.value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = a.grad[i] - b.grad[i];
+    }
+    return r;
+}
+
+template <int N>
+dual<N> operator*(const dual<N> &a, const dual<N> &b) {
+    dual<N> r;
+    r.value = a.value * b.value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = a.grad[i] * b.value + a.value * b.grad[i];
+    }
+    return r;
+}
+
+template <int N>
+dual<N> operator/(const dual<N> &a, const dual<N> &b) {
+    dual<N> r;
+    r.value = a.value / b.value;
+    const double inv = 1.0 / b.value;
+    for (int i = 0; i < N; i++) {
+        r.grad[i] = (a.grad[i] - r.value * b.grad[i]) * inv;
+    }
+    return r;
+}
+
+template <int N>
+dual<N> operator+(const dual<N> &a, const double b) {
+    dual<N> r = a;
+    r.value += b;
+    return r;
+}
+
+template <int N>
+dual<N> operator+(const double a, const dual<N> &b) {
+    return b + a;
+}
+
+template <int N>
+dual<N> operator-(const dual<N> &a, const double b) {
+    dual<N> r = a;
+    r.value -= b;
+    return r;
+}
+
+template <int N>
+dual<N> operator-(const double a, const dual<N> &b) {
+    return chain(b, a - b.value, -1.0);
+}
+
+template <int N>
+dual<N> operator*(const dual<N> &a, const double b) {
+    return chain(a, a.value * b, b);
+}
+
+template <int N>
+dual<N> operator*(const double a, const dual<N> &b) {
+    return chain(b, a * b.value, a);
+}
+
+template <int N>
+dual<N> operator/(const dual<N> &a, const double b) {
+    return chain(a, a.value / b, 1.0 / b);
+}
+
+template <int N>
+dual<N> operator/(const double a, const dual<N> &b) {
+    const double value = a / b.value;
+    return chain(b, value, -value / b.value);
+}
+
+template <int N>
+dual<N> sin(const dual<N> &a) {
+    return chain(a, std::sin(a.value), std::cos(a.value));
+}
+
+template <int N>
+dual<N> cos(const dual<N> &a) {
+    return chain(a, std::cos(a.value), -std::sin(a.value));
+}
+
+template <int N>
+dual<N> tan(const dual<N> &a) {
+    const double t = std::tan(a.value);
+    return chain(a, t, 1.0 + t * t);
+}
+
+template <int N>
+dual<N> exp(const dual<N> &a) {
+    const double e = std::exp(a.value);
+    return chain(a, e, e);
+}
+
+template <int N>
+dual<N> log(const dual<N> &a) {
+    return chain(a, std::log(a.value), 1.0 / a.value);
+}
+
+template <int N>
+dual<N> sqrt(const dual<N> &a) {
+    const double s = std::sqrt(a.value);
+    return chain(a, s, 0.5 / s);
+}
+
+template <int N>
+dual<N> pow(const dual<N> &a, const double p) {
+    return chain(a, std::pow(a.value, p), p * std::pow(a.value, p - 1.0));
+}
+
+template <int N>
+dual<N> fabs(const dual<N> &a) {
+    return chain(a, std::fabs(a.value), a.value < 0 ? -1.0 : 1.0);
+}
+
+/**
+ * @brief Значение и производная скалярной функции f в точке x за один проход.
+ *
+ * @param f функция, принимающая dual<1> (обобщенная лямбда или шаблон).
+ * @param value f(x) (выходной параметр).
+ * @return f'(x).
+*/
+template <class Function>
+double derivative(const Function &f, const double x, double &value) {
+    const dual<1> y = f(variable<1>(x, 0));
+    value = y.value;
+    return y.grad[0];
+}
+
+/**
+ * @brief Значения и матрица Якоби функции f: R^N -> R^M за один проход.
+ *
+ * @param f функция, принимающая std::array<dual<N>, N> и возвращающая
+ * std::array<dual<N>, M>. M и N задаются явно: jacobian<1, 2>(f, x, values, J).
+ * @param values f(x) (выходной параметр).
+ * @param J J[i][j] = df_i/dx_j (выходной параметр).
+*/
+template <int M, int N, class Function>
+void jacobian(const Function &f, const std::array<double, N> &x,
+              std::array<double, M> &values, std::array<std::array<double, N>, M> &J) {
+    std::array<dual<N>, N> args;
+    for (int j = 0; j < N; j++) {
+        args[j] = variable<N>(x[j], j);
+    }
+    const std::array<dual<N>, M> y = f(args);
+    for (int i = 0; i < M; i++) {
+        values[i] = y[i].value;
+        for (int j = 0; j < N; j++) {
+            J[i][j] = y[i].grad[j];
+        }
+    }
+}
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,562 @@
+#include "chebyshev.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+
+#include "metrics.h"
+
+namespace numerics {
+
+namespace {
+
+const int initial_degree = 16;
+const int root_split_degree = 64;
+
+/**
+ * @brief Быстрое преобразование Фурье по основанию 2 на месте (длина - степень двойки).
+*/
+void fft(std::vector<std::complex<double> > &v) {
+    const std::size_t n = v.size();
+    for (std::size_t i = 1, j = 0; i < n; i++) {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(v[i], v[j]);
+        }
+    }
+    for (std::size_t length = 2; length <= n; length <<= 1) {
+        const double angle = -2.0 * M_PI / length;
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (std::size_t i = 0; i < n; i += length) {
+            std::complex<double> w(1.0, 0.0);
+            for (std::size_t k = 0; k < length / 2; k++) {
+                const std::complex<double> even = v[i + k];
+                const std::complex<double> odd = v[i + k + length / 2] * w;
+                v[i + k] = even + odd;
+                v[i + k + length / 2] = even - odd;
+                w *= step;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Коэффициенты c_0..c_n интерполянта по значениям в точках cos(pi j / n).
+ *
+ * Дискретное косинус-преобразование первого типа как БПФ четного
+ * продолжения длины 2n.
+*/
+std::vector<double> chebyshev_coefficients(const std::vector<double> &values) {
+    const std::size_t n = values.size() - 1;
+    if (n == 0) {
+        return values;
+    }
+    std::vector<std::complex<double> > v(2 * n);
+    for (std::size_t j = 0; j <= n; j++) {
+        v[j] = values[j];
+    }
+    for (std::size_t j = 1; j < n; j++) {
+        v[2 * n - j] = values[j];
+    }
+    fft(v);
+    std::vector<double> c(n + 1);
+    for (std::size_t k = 0; k <= n; k++) {
+        c[k] = v[k].real() / n;
+    }
+    c[0] /= 2.0;
+    c[n] /= 2.0;
+    return c;
+}
+
+/**
+ * @brief Итог приближения куска: приближен, нужно делить, f не конечна во всех точках.
+*/
+enum fit_status {
+    fit_converged,
+    fit_failed,
+    fit_nonfinite,
+};
+
+/**
+ * @brief Приближение f на [a,b] одним многочленом степени не больше max_degree.
+ *
+ * @param evaluations счетчик вычислений f (увеличивается).
+ * @return fit_converged, если хвост коэффициентов ниже tolerance; тогда piece.coefficients
+ * обрезаны до последнего значимого. fit_nonfinite - ни одно значение f в точках
+ * первой степени не конечно: деление такого куска ничего не даст.
+*/
+fit_status fit_piece(const scalar_function &f, const double a, const double b, const chebyshev_settings &settings,
+                     chebyshev_piece &piece, long &evaluations) {
+    piece.a = a;
+    piece.b = b;
+    piece.converged = false;
+    piece.resolved = false;
+    const double mid = (a + b) / 2.0;
+    const double half = (b - a) / 2.0;
+
+    std::vector<double> values;
+    double previous_tail = 0.0;
+    for (int n = initial_degree; n <= settings.max_degree; n *= 2) {
+        // Точки степени n/2 - четные точки степени n
+        std::vector<double> next(n + 1);
+        for (int j = 0; j <= n; j++) {
+            if (!values.empty() && j % 2 == 0) {
+                next[j] = values[j / 2];
+            } else {
+                next[j] = f(mid + half * std::cos(M_PI * j / n));
+                evaluations++;
+                METRICS_COUNT("numerics.chebyshev.evaluations");
+            }
+        }
+        values.swap(next);
+
+        double scale = 0.0;
+        std::size_t finite = 0;
+        for (const double value: values) {
+            if (std::isfinite(value)) {
+                finite++;
+                scale = std::max(scale, std::fabs(value));
+            }
+        }
+        if (finite == 0 && n == initial_degree) {
+            return fit_nonfinite;
+        }
+        if (finite < values.size()) {
+            return fit_failed;
+        }
+        if (scale == 0.0) {
+            piece.coefficients.assign(1, 0.0);
+            piece.converged = true;
+            piece.resolved = true;
+            return fit_converged;
+        }
+
+        const std::vector<double> c = chebyshev_coefficients(values);
+        double tail = 0.0;
+        for (int k = n - n / 8 + 1; k <= n; k++) {
+            tail = std::max(tail, std::fabs(c[k]) / scale);
+        }
+
+        // Хвост ниже tolerance - f приближена. Хвост, переставший убывать при
+        // удвоении n, - шум вычисления f (например, tg x у полюса): если он не
+        // больше sqrt(tolerance), точнее f на этом куске не приблизить.
+        const bool resolved = tail <= settings.tolerance;
+        const bool plateau = n > initial_degree && tail >= 0.25 * previous_tail;
+        if (resolved || (plateau && tail <= std::sqrt(settings.tolerance))) {
+            const double threshold = std::max(settings.tolerance, resolved ? 0.0 : tail) * scale;
+            int degree = n;
+            while (degree > 0 && std::fabs(c[degree]) <= threshold) {
+                degree--;
+            }
+            piece.coefficients.assign(c.begin(), c.begin() + degree + 1);
+            piece.converged = true;
+            piece.resolved = resolved;
+            return fit_converged;
+        }
+        if (plateau) {
+            // Коэффициенты не убывают: выгоднее сразу делить кусок
+            return fit_failed;
+        }
+        previous_tail = tail;
+    }
+    return fit_failed;
+}
+
+void fit_interval(const scalar_function &f, const double a, const double b, const double min_width,
+                  const chebyshev_settings &settings, std::vector<chebyshev_piece> &pieces, long &evaluations) {
+    if (evaluations >= settings.max_evaluations || pieces.size() >= settings.max_pieces) {
+        METRICS_COUNT("numerics.chebyshev.budget_exhausted");
+        throw std::runtime_error("chebyshev_fit: исчерпан бюджет кусков или вычислений f");
+    }
+    chebyshev_piece piece;
+    const fit_status status = fit_piece(f, a, b, settings, piece, evaluations);
+    if (status != fit_failed || b - a < min_width) {
+        if (!piece.converged) {
+            METRICS_COUNT("numerics.chebyshev.unresolved_pieces");
+        }
+        pieces.push_back(piece);
+        return;
+    }
+    // Середина чуть смещена, чтобы не попадать точно в симметричные полюса
+    const double split = a + (b - a) * 0.5000123;
+    fit_interval(f, a, split, min_width, settings, pieces, evaluations);
+    fit_interval(f, split, b, min_width, settings, pieces, evaluations);
+}
+
+/**
+ * @brief Коэффициенты производной ряда по x (а не по t).
+*/
+std::vector<double> derivative_coefficients(const chebyshev_piece &piece) {
+    const std::vector<double> &c = piece.coefficients;
+    const int n = static_cast<int>(c.size()) - 1;
+    if (n == 0) {
+        return std::vector<double>(1, 0.0);
+    }
+    std::vector<double> d(n + 1, 0.0);
+    for (int k = n; k >= 1; k--) {
+        d[k - 1] = (k + 1 <= n ? d[k + 1] : 0.0) + 2.0 * k * c[k];
+    }
+    d[0] /= 2.0;
+    d.resize(n);
+    const double scale = 2.0 / (piece.b - piece.a);
+    for (double &value: d) {
+        value *= scale;
+    }
+    return d;
+}
+
+/**
+ * @brief Балансировка матрицы диагональным подобием (степенями двойки):
+ * выравнивает нормы строк и столбцов, что уменьшает ошибку собственных чисел.
+*/
+void balance(std::vector<double> &A, const int n) {
+    const double radix = 2.0;
+    const double radix2 = radix * radix;
+    bool done = false;
+    while (!done) {
+        done = true;
+        for (int i = 0; i < n; i++) {
+            double r = 0.0, c = 0.0;
+            for (int j = 0; j < n; j++) {
+                if (j != i) {
+                    c += std::fabs(A[j * n + i]);
+                    r += std::fabs(A[i * n + j]);
+                }
+            }
+            if (c == 0.0 || r == 0.0) {
+                continue;
+            }
+            double g = r / radix;
+            double f = 1.0;
+            const double s = c + r;
+            while (c < g) {
+                f *= radix;
+                c *= radix2;
+            }
+            g = r * radix;
+            while (c > g) {
+                f /= radix;
+                c /= radix2;
+            }
+            if ((c + r) / f < 0.95 * s) {
+                done = false;
+                for (int j = 0; j < n; j++) {
+                    A[i * n + j] /= f;
+                    A[j * n + i] *= f;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Собственные числа верхней хессенберговой матрицы n x n (построчно):
+ * QR-алгоритм Фрэнсиса с двойным сдвигом. Матрица разрушается.
+*/
+std::vector<std::complex<double> > hessenberg_eigenvalues(std::vector<double> &A, const int n) {
+    const double eps = std::numeric_limits<double>::epsilon();
+    auto a = [&A, n](const int i, const int j) -> double & {
+        return A[i * n + j];
+    };
+    std::vector<std::complex<double> > w(n);
+
+    double norm = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = std::max(i - 1, 0); j < n; j++) {
+            norm += std::fabs(a(i, j));
+        }
+    }
+
+    int nn = n - 1;
+    double t = 0.0;
+    while (nn >= 0) {
+        int its = 0;
+        int l;
+        do {
+            // Поиск малого поддиагонального элемента: матрица распадается
+            for (l = nn; l > 0; l--) {
+                double s = std::fabs(a(l - 1, l - 1)) + std::fabs(a(l, l));
+                if (s == 0.0) {
+                    s = norm;
+                }
+                if (std::fabs(a(l, l - 1)) <= eps * s) {
+                    a(l, l - 1) = 0.0;
+                    break;
+                }
+            }
+            double x = a(nn, nn);
+            if (l == nn) {
+                w[nn--] = x + t;
+            } else {
+                double y = a(nn - 1, nn - 1);
+                double ww = a(nn, nn - 1) * a(nn - 1, nn);
+                if (l == nn - 1) {
+                    // Блок 2 x 2: пара вещественных или комплексно-сопряженных чисел
+                    const double p = 0.5 * (y - x);
+                    const double q = p * p + ww;
+                    double z = std::sqrt(std::fabs(q));
+                    x += t;
+                    if (q >= 0.0) {
+                        z = p + (p >= 0.0 ? z : -z);
+                        w[nn - 1] = w[nn] = x + z;
+                        if (z != 0.0) {
+                            w[nn] = x - ww / z;
+                        }
+                    } else {
+                        w[nn] = std::complex<double>(x + p, -z);
+                        w[nn - 1] = std::conj(w[nn]);
+                    }
+                    nn -= 2;
+                } else {
+                    if (its == 60) {
+                        throw std::runtime_error("hessenberg_eigenvalues: QR-алгоритм не сошелся");
+                    }
+                    if (its == 10 || its == 20 || its == 40) {
+                        // Исключительный сдвиг
+                        t += x;
+                        for (int i = 0; i <= nn; i++) {
+                            a(i, i) -= x;
+                        }
+                        const double s = std::fabs(a(nn, nn - 1)) + std::fabs(a(nn - 1, nn - 2));
+                        y = x = 0.75 * s;
+                        ww = -0.4375 * s * s;
+                    }
+                    ++its;
+                    int m;
+                    double p = 0.0, q = 0.0, r = 0.0, z;
+                    for (m = nn - 2; m >= l; m--) {
+                        z = a(m, m);
+                        r = x - z;
+                        double s = y - z;
+                        p = (r * s - ww) / a(m + 1, m) + a(m, m + 1);
+                        q = a(m + 1, m + 1) - z - r - s;
+                        r = a(m + 2, m + 1);
+                        s = std::fabs(p) + std::fabs(q) + std::fabs(r);
+                        p /= s;
+                        q /= s;
+                        r /= s;
+                        if (m == l) {
+                            break;
+                        }
+                        const double u = std::fabs(a(m, m - 1)) * (std::fabs(q) + std::fabs(r));
+                        const double v = std::fabs(p) * (std::fabs(a(m - 1, m - 1)) + std::fabs(z)
+                                                         + std::fabs(a(m + 1, m + 1)));
+                        if (u <= eps * v) {
+                            break;
+                        }
+                    }
+                    for (int i = m; i < nn - 1; i++) {
+                        a(i + 2, i) = 0.0;
+                        if (i != m) {
+                            a(i + 2, i - 1) = 0.0;
+                        }
+                    }
+                    // Шаг QR с двойным сдвигом отражениями Хаусхолдера
+                    for (int k = m; k < nn; k++) {
+                        if (k != m) {
+                            p = a(k, k - 1);
+                            q = a(k + 1, k - 1);
+                            r = (k + 1 != nn) ? a(k + 2, k - 1) : 0.0;
+                            x = std::fabs(p) + std::fabs(q) + std::fabs(r);
+                            if (x != 0.0) {
+                                p /= x;
+                                q /= x;
+                                r /= x;
+                            }
+                        }
+                        double s = std::sqrt(p * p + q * q + r * r);
+                        if (p < 0.0) {
+                            s = -s;
+                        }
+                        if (s == 0.0) {
+                            continue;
+                        }
+                        if (k == m) {
+                            if (l != m) {
+                                a(k, k - 1) = -a(k, k - 1);
+                            }
+                        } else {
+                            a(k, k - 1) = -s * x;
+                        }
+                        p += s;
+                        x = p / s;
+                        y = q / s;
+                        z = r / s;
+                        q /= p;
+                        r /= p;
+                        for (int j = k; j <= nn; j++) {
+                            p = a(k, j) + q * a(k + 1, j);
+                            if (k + 1 != nn) {
+                                p += r * a(k + 2, j);
+                                a(k + 2, j) -= p * z;
+                            }
+                            a(k + 1, j) -= p * y;
+                            a(k, j) -= p * x;
+                        }
+                        const int last = std::min(nn, k + 3);
+                        for (int i = l; i <= last; i++) {
+                            p = x * a(i, k) + y * a(i, k + 1);
+                            if (k + 1 != nn) {
+                                p += z * a(i, k + 2);
+                                a(i, k + 2) -= p * r;
+                            }
+                            a(i, k + 1) -= p * q;
+                            a(i, k) -= p;
+                        }
+                    }
+                }
+            }
+        } while (nn >= 0 && l + 1 < nn);
+    }
+    return w;
+}
+
+/**
+ * @brief Корни ряда c_0 T_0 + ... + c_m T_m на [-1,1]: собственные числа
+ * транспонированной матрицы-компаньона (она верхняя хессенбергова).
+*/
+std::vector<double> colleague_roots(const std::vector<double> &c) {
+    const int m = static_cast<int>(c.size()) - 1;
+    std::vector<double> roots;
+    if (m < 1) {
+        return roots;
+    }
+    if (m == 1) {
+        // Корень прямой может лежать вне куска - тот же отбор, что для собственных чисел
+        const double t = -c[0] / c[1];
+        if (std::fabs(t) <= 1.0 + 1e-8) {
+            roots.push_back(std::max(-1.0, std::min(1.0, t)));
+        }
+        return roots;
+    }
+    // Строки x T_0 = T_1, x T_k = (T_{k-1} + T_{k+1}) / 2, в последней T_m выражен через p(x) / c_m
+    std::vector<double> A(m * m, 0.0);
+    A[1 * m + 0] = 1.0;
+    for (int k = 1; k < m; k++) {
+        A[(k - 1) * m + k] = 0.5;
+        if (k + 1 < m) {
+            A[(k + 1) * m + k] = 0.5;
+        }
+    }
+    for (int j = 0; j < m; j++) {
+        A[j * m + (m - 1)] -= c[j] / (2.0 * c[m]);
+    }
+    balance(A, m);
+
+    const std::vector<std::complex<double> > eigenvalues = hessenberg_eigenvalues(A, m);
+    for (const std::complex<double> &z: eigenvalues) {
+        if (std::fabs(z.imag()) <= 1e-8 && std::fabs(z.real()) <= 1.0 + 1e-8) {
+            roots.push_back(std::max(-1.0, std::min(1.0, z.real())));
+        }
+    }
+    return roots;
+}
+
+/**
+ * @brief Корни куска. df - точная производная f или пустая функция: тогда шаг
+ * Ньютона идет по производной многочлена и только на кусках с resolved = true.
+*/
+void piece_roots(const scalar_function &f, const scalar_function &df, const chebyshev_piece &piece,
+                 const chebyshev_settings &settings, std::vector<double> &roots) {
+    if (!piece.converged || piece.coefficients.size() < 2) {
+        return;
+    }
+    if (static_cast<int>(piece.coefficients.size()) - 1 > root_split_degree) {
+        // Собственные числа стоят O(m^3): куски высокой степени делятся пополам
+        // повторным приближением самого ряда, без новых вычислений f
+        const scalar_function series = [&piece](const double x) { return chebyshev_evaluate(piece, x); };
+        const double mid = (piece.a + piece.b) / 2.0;
+        chebyshev_piece left, right;
+        long evaluations = 0;
+        if (fit_piece(series, piece.a, mid, settings, left, evaluations) == fit_converged
+            && fit_piece(series, mid, piece.b, settings, right, evaluations) == fit_converged) {
+            // Половины точны настолько же, насколько сам ряд
+            left.resolved = left.resolved && piece.resolved;
+            right.resolved = right.resolved && piece.resolved;
+            piece_roots(f, df, left, settings, roots);
+            piece_roots(f, df, right, settings, roots);
+            return;
+        }
+    }
+
+    const chebyshev_piece derivative = {piece.a, piece.b, derivative_coefficients(piece), true, piece.resolved};
+    const scalar_function series_derivative = [&derivative](const double x) {
+        return chebyshev_evaluate(derivative, x);
+    };
+    const bool polish = df || piece.resolved;
+    const double mid = (piece.a + piece.b) / 2.0;
+    const double half = (piece.b - piece.a) / 2.0;
+    for (const double t: colleague_roots(piece.coefficients)) {
+        double x = mid + half * t;
+        if (polish) {
+            // Один шаг Ньютона по самой f уточняет корень многочлена
+            const double fx = f(x);
+            const double polished = newton_method(f, df ? df : series_derivative, x,
+                                                  std::numeric_limits<double>::infinity(), 1);
+            if (std::isfinite(fx) && polished >= piece.a && polished <= piece.b
+                && std::fabs(f(polished)) <= std::fabs(fx)) {
+                x = polished;
+            }
+        }
+        roots.push_back(x);
+    }
+}
+
+} // namespace
+
+std::vector<chebyshev_piece> chebyshev_fit(const scalar_function &f, const double a, const double b,
+                                           const chebyshev_settings &settings) {
+    if (!(a < b)) {
+        throw std::invalid_argument("chebyshev_fit: нужно a < b");
+    }
+    std::vector<chebyshev_piece> pieces;
+    long evaluations = 0;
+    fit_interval(f, a, b, settings.min_width * (b - a), settings, pieces, evaluations);
+    METRICS_ADD("numerics.chebyshev.pieces", pieces.size());
+    return pieces;
+}
+
+double chebyshev_evaluate(const chebyshev_piece &piece, const double x) {
+    const std::vector<double> &c = piece.coefficients;
+    const double t = (2.0 * x - piece.a - piece.b) / (piece.b - piece.a);
+    double b1 = 0.0, b2 = 0.0;
+    for (std::size_t k = c.size() - 1; k >= 1; k--) {
+        const double b0 = c[k] + 2.0 * t * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return c[0] + t * b1 - b2;
+}
+
+std::vector<double> chebyshev_roots(const scalar_function &f, const double a, const double b,
+                                    const chebyshev_settings &settings) {
+    return chebyshev_roots(f, scalar_function(), a, b, settings);
+}
+
+std::vector<double> chebyshev_roots(const scalar_function &f, const scalar_function &df, const double a,
+                                    const double b, const chebyshev_settings &settings) {
+    METRICS_TIMER("numerics.chebyshev_roots");
+    const std::vector<chebyshev_piece> pieces = chebyshev_fit(f, a, b, settings);
+    std::vector<double> roots;
+    for (const chebyshev_piece &piece: pieces) {
+        piece_roots(f, df, piece, settings, roots);
+    }
+    std::sort(roots.begin(), roots.end());
+
+    // Корни на границах кусков и кратные корни дают близкие дубликаты
+    std::vector<double> unique;
+    for (const double root: roots) {
+        if (unique.empty() || root - unique.back() > 1e-8 * (b - a)) {
+            unique.push_back(root);
+        }
+    }
+    return unique;
+}
+
+} // namespace numerics
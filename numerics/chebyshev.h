@@ -0,0 +1,98 @@
+#ifndef NUMERICS_CHEBYSHEV_H
+#define NUMERICS_CHEBYSHEV_H
+
+#include <cstddef>
+#include <vector>
+
+#include "roots.h"
+
+namespace numerics {
+
+/**
+ * @brief Кусок чебышевской аппроксимации: f(x) ~ sum_k c_k T_k(t) на [a,b],
+ * t = (2x - a - b) / (b - a).
+ *
+ * converged = false у кусков, где f не удалось приблизить многочленом
+ * до минимальной ширины (полюс, разрыв), и у кусков, где f не конечна ни в одной
+ * точке (переполнение, область вне определения f): такие куски не делятся,
+ * их коэффициенты не используются.
+ * resolved = false у кусков, принятых с точностью шума f (хвост коэффициентов
+ * не опустился ниже tolerance, но не хуже sqrt(tolerance)): производная такого
+ * многочлена известна лишь с той же точностью.
+*/
+struct chebyshev_piece {
+    double a;
+    double b;
+    std::vector<double> coefficients;
+    bool converged;
+    bool resolved;
+};
+
+/**
+ * @brief Настройки адаптивной чебышевской аппроксимации.
+ *
+ * tolerance - относительная точность коэффициентов (по максимуму |f| на куске);
+ * если f вычисляется с шумом больше tolerance (tg x у полюса), кусок принимается
+ * с точностью шума, пока она не хуже sqrt(tolerance). max_degree - наибольшая
+ * степень на одном куске (степень двойки): если ее не хватает, кусок делится
+ * пополам; min_width - доля длины [a,b], меньше которой куски не делятся.
+ * max_pieces и max_evaluations - бюджет на число кусков и вычислений f: при его
+ * исчерпании chebyshev_fit бросает std::runtime_error, а не делит отрезок дальше
+ * (иначе f с особенностями всюду дала бы до 1 / min_width кусков).
+*/
+struct chebyshev_settings {
+    double tolerance;
+    int max_degree;
+    double min_width;
+    std::size_t max_pieces;
+    long max_evaluations;
+};
+
+const chebyshev_settings default_chebyshev_settings = {1e-13, 128, 1e-10, 10000, 2000000};
+
+/**
+ * @brief Кусочная чебышевская аппроксимация f на [a,b].
+ *
+ * На каждом куске f вычисляется в точках Чебышева x_j = cos(pi j / n),
+ * n = 16, 32, ..., max_degree (точки вложены, значения переиспользуются),
+ * коэффициенты - дискретное косинус-преобразование через БПФ. Степень растет,
+ * пока хвост коэффициентов не опустится ниже tolerance; иначе кусок делится
+ * пополам. Так около полюсов (например, у tg x) куски мельчают автоматически,
+ * а гладкие участки обходятся одним многочленом.
+*/
+std::vector<chebyshev_piece> chebyshev_fit(const scalar_function &f, double a, double b,
+                                           const chebyshev_settings &settings = default_chebyshev_settings);
+
+/**
+ * @brief Значение куска в точке x (схема Кленшоу).
+*/
+double chebyshev_evaluate(const chebyshev_piece &piece, double x);
+
+/**
+ * @brief Все вещественные корни f на [a,b] сразу.
+ *
+ * Корни каждого куска - собственные числа матрицы-компаньона для базиса
+ * Чебышева (colleague matrix), найденные QR-алгоритмом; куски степени больше 64
+ * перед этим делятся пополам. Каждый корень уточняется одним шагом Ньютона
+ * по f и производной аппроксимации; на кусках с resolved = false эта производная
+ * неточна, и корень остается собственным числом. Стоимость определяется сложностью f
+ * (степенью и числом кусков), а не числом начальных приближений.
+ *
+ * @return корни в порядке возрастания; у кусков с converged = false корни не ищутся.
+*/
+std::vector<double> chebyshev_roots(const scalar_function &f, double a, double b,
+                                    const chebyshev_settings &settings = default_chebyshev_settings);
+
+/**
+ * @brief Все вещественные корни f на [a,b] с уточнением по точной производной.
+ *
+ * @param df производная f (например, numerics::derivative от шаблонной f):
+ * шаг Ньютона newton_method(f, df, ...) уточняет корни на всех кусках, в том числе
+ * принятых с точностью шума.
+*/
+std::vector<double> chebyshev_roots(const scalar_function &f, const scalar_function &df, double a, double b,
+                                    const chebyshev_settings &settings = default_chebyshev_settings);
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef NUMERICS_COMPENSATED_H
+#define NUMERICS_COMPENSATED_H
+
+#include <cmath>
+#include <cstddef>
+
+namespace numerics {
+
+/**
+ * @brief Число double-double: значение hi + lo, |lo| <= ulp(hi) / 2.
+ *
+ * Около 106 бит мантиссы (~32 десятичных знака) на обычной арифметике
+ * double: операции построены на безошибочных преобразованиях two_sum и
+ * two_prod, не содержат ветвлений и векторизуются в циклах по массивам.
+ *
+ * Алгоритмы корректны только при строгой арифметике IEEE: без -ffast-math
+ * и без сжатия a * b + c в FMA. GCC по умолчанию сжимает (-ffp-contract=fast)
+ * везде, где FMA доступна: при -mfma/-march=native и в вариантах avx2/avx512f
+ * функций NUMERICS_DISPATCH, поэтому нужен явный -ffp-contract=off. CMake-цель
+ * numerics передает его и всем, кто ее подключает; run.sh заданий - тоже.
+*/
+struct double_double {
+    double hi;
+    double lo;
+};
+
+inline double_double make_double_double(const double x) {
+    double_double r = {x, 0.0};
+    return r;
+}
+
+inline double to_double(const double_double &a) {
+    return a.hi + a.lo;
+}
+
+/**
+ * @brief s + e = a + b точно (Кнут, без условия на порядок a и b).
+*/
+inline double_double two_sum(const double a, const double b) {
+    const double s = a + b;
+    const double bb = s - a;
+    double_double r = {s, (a - (s - bb)) + (b - bb)};
+    return r;
+}
+
+/**
+ * @brief s + e = a + b точно при |a| >= |b| (Деккер).
+*/
+inline double_double quick_two_sum(const double a, const double b) {
+    const double s = a + b;
+    double_double r = {s, b - (s - a)};
+    return r;
+}
+
+/**
+ * @brief p + e = a * b точно: через аппаратный FMA или расщепление Деккера.
+*/
+inline double_double two_prod(const double a, const double b) {
+    const double p = a * b;
+#ifdef __FMA__
+    double_double r = {p, std::fma(a, b, -p)};
+#else
+    const double split = 134217729.0; // 2^27 + 1
+    const double ta = split * a;
+    const double a_hi = ta - (ta - a);
+    const double a_lo = a - a_hi;
+    const double tb = split * b;
+    const double b_hi = tb - (tb - b);
+    const double b_lo = b - b_hi;
+    double_double r = {p, ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo};
+#endif
+    return r;
+}
+
+inline double_double operator-(const double_double &a) {
+    double_double r = {-a.hi, -a.lo};
+    return r;
+}
+
+inline double_double operator+(const double_double &a, const double b) {
+    double_double s = two_sum(a.hi, b);
+    s.lo += a.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+inline double_double operator+(const double_double &a, const double_double &b) {
+    double_double s = two_sum(a.hi, b.hi);
+    const double_double t = two_sum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = quick_two_sum(s.hi, s.lo);
+    s.lo += t.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+inline double_double operator-(const double_double &a, const double b) {
+    return a + (-b);
+}
+
+inline double_double operator-(const double_double &a, const double_double &b) {
+    return a + (-b);
+}
+
+inline double_double operator*(const double_double &a, const double b) {
+    double_double p = two_prod(a.hi, b);
+    p.lo += a.lo * b;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+inline double_double operator*(const double_double &a, const double_double &b) {
+    double_double p = two_prod(a.hi, b.hi);
+    p.lo += a.hi * b.lo + a.lo * b.hi;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+inline double_double operator/(const double_double &a, const double b) {
+    const double q1 = a.hi / b;
+    const double_double p = two_prod(q1, b);
+    double_double s = two_sum(a.hi, -p.hi);
+    s.lo -= p.lo;
+    s.lo += a.lo;
+    const double q2 = (s.hi + s.lo) / b;
+    return quick_two_sum(q1, q2);
+}
+
+inline double_double operator/(const double_double &a, const double_double &b) {
+    const double q1 = a.hi / b.hi;
+    double_double r = a - b * q1;
+    const double q2 = r.hi / b.hi;
+    r = r - b * q2;
+    const double q3 = r.hi / b.hi;
+    return quick_two_sum(q1, q2) + q3;
+}
+
+/**
+ * @brief Сумматор Кэхэна: поправка c хранит потерянные младшие разряды.
+ *
+ * Погрешность суммы n слагаемых O(eps) вместо O(n eps), но если
+ * слагаемое по модулю больше накопленной суммы, поправка теряется.
+*/
+class kahan_accumulator {
+public:
+    kahan_accumulator()
+        : sum_(0.0), c_(0.0) {
+    }
+
+    void add(const double x) {
+        const double y = x - c_;
+        const double t = sum_ + y;
+        c_ = (t - sum_) - y;
+        sum_ = t;
+    }
+
+    double value() const {
+        return sum_;
+    }
+
+private:
+    double sum_;
+    double c_;
+};
+
+/**
+ * @brief Сумматор Ноймайера: Кэхэн, исправленный для слагаемых больше суммы.
+ *
+ * Подходит для знакопеременных рядов, где частичная сумма много меньше
+ * отдельных слагаемых.
+*/
+class neumaier_accumulator {
+public:
+    neumaier_accumulator()
+        : sum_(0.0), c_(0.0) {
+    }
+
+    void add(const double x) {
+        const double t = sum_ + x;
+        if (std::fabs(sum_) >= std::fabs(x)) {
+            c_ += (sum_ - t) + x;
+        } else {
+            c_ += (x - t) + sum_;
+        }
+        sum_ = t;
+    }
+
+    double value() const {
+        return sum_ + c_;
+    }
+
+private:
+    double sum_;
+    double c_;
+};
+
+/**
+ * @brief Сумма массива любым сумматором: compensated_sum<neumaier_accumulator>(x, n).
+*/
+template <class Accumulator>
+double compensated_sum(const double *x, const std::size_t n) {
+    Accumulator acc;
+    for (std::size_t i = 0; i < n; i++) {
+        acc.add(x[i]);
+    }
+    return acc.value();
+}
+
+} // namespace numerics
+
+#endif
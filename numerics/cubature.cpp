@@ -0,0 +1,426 @@
+#include "cubature.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "compensated.h"
+#include "metrics.h"
+#include "quadrature.h"
+
+namespace numerics {
+
+namespace {
+
+const std::size_t block_points = 256;
+
+std::atomic<int> thread_setting(0);
+
+int thread_count() {
+    const int setting = thread_setting.load();
+    if (setting > 0) {
+        return setting;
+    }
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : static_cast<int>(hardware);
+}
+
+/**
+ * @brief Заполнение блока: n точек начиная с номера first и их веса.
+*/
+typedef std::function<void(std::size_t first, std::size_t n, double *points, double *weights)> block_filler;
+
+/**
+ * @brief Взвешенная сумма w_i f(x_i) по count точкам.
+ *
+ * Блоки по block_points точек раздаются потокам через атомарный счетчик.
+ * Сумма каждого блока считается в double-double и сохраняется отдельно,
+ * затем блоки складываются по порядку - результат не зависит от числа потоков.
+*/
+double weighted_sum(const batch_field &f, const int dim, const std::size_t count, const block_filler &fill) {
+    METRICS_ADD("numerics.cubature.points", count);
+    const std::size_t blocks = (count + block_points - 1) / block_points;
+    std::vector<double_double> partial(blocks);
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        std::vector<double> points(block_points * dim);
+        std::vector<double> weights(block_points);
+        std::vector<double> values(block_points);
+        try {
+            for (std::size_t b = next++; b < blocks; b = next++) {
+                const std::size_t first = b * block_points;
+                const std::size_t n = (count - first < block_points) ? count - first : block_points;
+                fill(first, n, points.data(), weights.data());
+                f(points.data(), values.data(), n);
+                double_double sum = make_double_double(0.0);
+                for (std::size_t i = 0; i < n; i++) {
+                    sum = sum + weights[i] * values[i];
+                }
+                partial[b] = sum;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = blocks;
+        }
+    };
+
+    const std::size_t threads = std::min<std::size_t>(static_cast<std::size_t>(thread_count()), blocks);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &t: pool) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    double_double total = make_double_double(0.0);
+    for (const double_double &p: partial) {
+        total = total + p;
+    }
+    return to_double(total);
+}
+
+void check_box(const std::vector<double> &a, const std::vector<double> &b, const char *method) {
+    if (a.empty() || a.size() != b.size()) {
+        throw std::invalid_argument(std::string(method) + ": границы a и b должны быть одной ненулевой длины");
+    }
+}
+
+/**
+ * @brief Формула Кленшоу-Кертиса уровня i на [-1,1]: 1 узел при i = 1,
+ * 2^(i-1) + 1 узлов x_j = -cos(pi j / (m - 1)) при i > 1.
+*/
+quadrature_rule clenshaw_curtis_rule(const int i) {
+    quadrature_rule rule;
+    if (i == 1) {
+        rule.nodes.push_back(0.0);
+        rule.weights.push_back(2.0);
+        return rule;
+    }
+    const int n = 1 << (i - 1);
+    for (int j = 0; j <= n; j++) {
+        rule.nodes.push_back(-cos(M_PI * j / n));
+        double s = 0.0;
+        for (int k = 1; k <= n / 2; k++) {
+            const double b = (2 * k == n) ? 1.0 : 2.0;
+            s += b / (4.0 * k * k - 1.0) * cos(2.0 * k * M_PI * j / n);
+        }
+        const double c = (j == 0 || j == n) ? 1.0 : 2.0;
+        rule.weights.push_back(c / n * (1.0 - s));
+    }
+    return rule;
+}
+
+/**
+ * @brief Перебор мультииндексов l (l_i >= 1) с |l| в [lo, hi].
+*/
+void for_each_level(std::vector<int> &l, const int d, const int sum, const int lo, const int hi,
+                    const std::function<void(const std::vector<int> &, int)> &visit) {
+    const int dim = static_cast<int>(l.size());
+    if (d == dim) {
+        if (sum >= lo) {
+            visit(l, sum);
+        }
+        return;
+    }
+    for (int v = 1; sum + v + (dim - d - 1) <= hi; v++) {
+        l[d] = v;
+        for_each_level(l, d + 1, sum + v, lo, hi, visit);
+    }
+}
+
+double binomial(const int n, const int k) {
+    double r = 1.0;
+    for (int i = 1; i <= k; i++) {
+        r = r * (n - k + i) / i;
+    }
+    return r;
+}
+
+/**
+ * @brief Направляющие числа Соболя (Джо-Куо, new-joe-kuo-6.21201) для размерностей 2..12:
+ * степень s примитивного многочлена, его коэффициенты a и начальные m_1..m_s.
+*/
+struct sobol_polynomial {
+    int s;
+    unsigned a;
+    unsigned m[5];
+};
+
+const sobol_polynomial sobol_table[sobol_max_dimension - 1] = {
+    {1, 0, {1, 0, 0, 0, 0}},
+    {2, 1, {1, 3, 0, 0, 0}},
+    {3, 1, {1, 3, 1, 0, 0}},
+    {3, 2, {1, 1, 1, 0, 0}},
+    {4, 1, {1, 1, 3, 3, 0}},
+    {4, 4, {1, 3, 5, 13, 0}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+};
+
+const int sobol_bits = 32;
+
+/**
+ * @brief Направляющие числа v_k (k < 32) размерности dim, выровненные по старшему биту.
+*/
+std::vector<std::uint32_t> sobol_directions(const int dim) {
+    std::vector<std::uint32_t> v(sobol_bits);
+    if (dim == 0) {
+        for (int k = 0; k < sobol_bits; k++) {
+            v[k] = 1u << (sobol_bits - 1 - k);
+        }
+        return v;
+    }
+    const sobol_polynomial &p = sobol_table[dim - 1];
+    std::vector<std::uint32_t> m(sobol_bits);
+    for (int k = 0; k < sobol_bits; k++) {
+        if (k < p.s) {
+            m[k] = p.m[k];
+        } else {
+            m[k] = m[k - p.s] ^ (m[k - p.s] << p.s);
+            for (int j = 1; j < p.s; j++) {
+                if ((p.a >> (p.s - 1 - j)) & 1u) {
+                    m[k] ^= m[k - j] << j;
+                }
+            }
+        }
+        v[k] = m[k] << (sobol_bits - 1 - k);
+    }
+    return v;
+}
+
+/**
+ * @brief splitmix64 - генератор случайных бит для скрэмблирования.
+*/
+std::uint64_t splitmix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int parity(std::uint32_t x) {
+    return __builtin_parity(x);
+}
+
+/**
+ * @brief Линейное скрэмблирование Матушека: v' = L v, где L - случайная
+ * нижнетреугольная двоичная матрица с единичной диагональю (цифра i
+ * результата - четность строки i матрицы, умноженной на цифры v).
+*/
+void scramble(std::vector<std::uint32_t> &v, std::uint64_t &state) {
+    std::uint32_t rows[sobol_bits];
+    for (int i = 0; i < sobol_bits; i++) {
+        const std::uint32_t diagonal = 1u << (sobol_bits - 1 - i);
+        const std::uint32_t above = ~(diagonal | (diagonal - 1u)); // цифры j < i - старшие биты
+        rows[i] = diagonal | (static_cast<std::uint32_t>(splitmix64(state)) & above);
+    }
+    for (std::uint32_t &direction: v) {
+        std::uint32_t r = 0;
+        for (int i = 0; i < sobol_bits; i++) {
+            r |= static_cast<std::uint32_t>(parity(rows[i] & direction)) << (sobol_bits - 1 - i);
+        }
+        direction = r;
+    }
+}
+
+} // namespace
+
+void set_cubature_threads(const int threads) {
+    thread_setting = threads < 0 ? 0 : threads;
+}
+
+double tensor_gauss(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b, const int nodes) {
+    check_box(a, b, "tensor_gauss");
+    const int dim = static_cast<int>(a.size());
+    const quadrature_rule rule = gauss_legendre_rule(nodes);
+
+    std::size_t count = 1;
+    for (int d = 0; d < dim; d++) {
+        if (count > (std::size_t(1) << 40) / nodes) {
+            throw std::invalid_argument("tensor_gauss: слишком много точек, используйте smolyak или sobol_qmc");
+        }
+        count *= nodes;
+    }
+
+    std::vector<double> scale(dim);
+    std::vector<double> shift(dim);
+    for (int d = 0; d < dim; d++) {
+        scale[d] = (b[d] - a[d]) / 2.0;
+        shift[d] = (a[d] + b[d]) / 2.0;
+    }
+
+    return weighted_sum(f, dim, count, [&](const std::size_t first, const std::size_t n, double *points, double *weights) {
+        for (std::size_t i = 0; i < n; i++) {
+            std::size_t index = first + i;
+            double w = 1.0;
+            for (int d = 0; d < dim; d++) {
+                const std::size_t k = index % nodes;
+                index /= nodes;
+                points[i * dim + d] = shift[d] + scale[d] * rule.nodes[k];
+                w *= rule.weights[k] * scale[d];
+            }
+            weights[i] = w;
+        }
+    });
+}
+
+double smolyak(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b, const int level) {
+    check_box(a, b, "smolyak");
+    if (level < 0) {
+        throw std::invalid_argument("smolyak: уровень должен быть неотрицательным");
+    }
+    const int dim = static_cast<int>(a.size());
+    const int q = dim + level;
+    const int finest = level + 1;
+
+    std::vector<quadrature_rule> rules(finest + 1);
+    for (int i = 1; i <= finest; i++) {
+        rules[i] = clenshaw_curtis_rule(i);
+    }
+
+    // Номер узла j формулы уровня i на самой мелкой сетке: узлы вложены
+    auto position = [finest](const int i, const int j) {
+        if (finest == 1) {
+            return 0;
+        }
+        if (i == 1) {
+            return 1 << (finest - 2);
+        }
+        return j << (finest - i);
+    };
+
+    std::map<std::vector<int>, double> grid;
+    std::vector<int> l(dim);
+    for_each_level(l, 0, 0, std::max(dim, q - dim + 1), q, [&](const std::vector<int> &levels, const int sum) {
+        const double coefficient = (((q - sum) % 2) ? -1.0 : 1.0) * binomial(dim - 1, q - sum);
+        std::vector<int> j(dim, 0);
+        std::vector<int> key(dim);
+        while (true) {
+            double w = coefficient;
+            for (int d = 0; d < dim; d++) {
+                w *= rules[levels[d]].weights[j[d]];
+                key[d] = position(levels[d], j[d]);
+            }
+            grid[key] += w;
+
+            int d = 0;
+            while (d < dim && ++j[d] == static_cast<int>(rules[levels[d]].nodes.size())) {
+                j[d] = 0;
+                d++;
+            }
+            if (d == dim) {
+                break;
+            }
+        }
+    });
+
+    const std::vector<double> &finest_nodes = rules[finest].nodes;
+    std::vector<double> points;
+    std::vector<double> weights;
+    double volume = 1.0;
+    for (int d = 0; d < dim; d++) {
+        volume *= (b[d] - a[d]) / 2.0;
+    }
+    for (const auto &entry: grid) {
+        if (entry.second == 0.0) {
+            continue;
+        }
+        for (int d = 0; d < dim; d++) {
+            points.push_back((a[d] + b[d]) / 2.0 + (b[d] - a[d]) / 2.0 * finest_nodes[entry.first[d]]);
+        }
+        weights.push_back(entry.second * volume);
+    }
+
+    return weighted_sum(f, dim, weights.size(), [&](const std::size_t first, const std::size_t n, double *p, double *w) {
+        std::copy(points.begin() + first * dim, points.begin() + (first + n) * dim, p);
+        std::copy(weights.begin() + first, weights.begin() + first + n, w);
+    });
+}
+
+qmc_estimate sobol_qmc(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b,
+                       const std::size_t points, const int replicates, const std::uint64_t seed) {
+    check_box(a, b, "sobol_qmc");
+    const int dim = static_cast<int>(a.size());
+    if (dim > sobol_max_dimension) {
+        throw std::invalid_argument("sobol_qmc: размерность больше sobol_max_dimension");
+    }
+    if (replicates < 2 || points == 0 || points > (std::size_t(1) << sobol_bits)) {
+        throw std::invalid_argument("sobol_qmc: нужно не меньше 2 реплик и от 1 до 2^32 точек");
+    }
+
+    double volume = 1.0;
+    for (int d = 0; d < dim; d++) {
+        volume *= b[d] - a[d];
+    }
+    const double weight = volume / static_cast<double>(points);
+
+    std::vector<double> estimates;
+    std::uint64_t state = seed;
+    for (int r = 0; r < replicates; r++) {
+        std::vector<std::vector<std::uint32_t> > directions(dim);
+        std::vector<std::uint32_t> shifts(dim);
+        for (int d = 0; d < dim; d++) {
+            directions[d] = sobol_directions(d);
+            scramble(directions[d], state);
+            shifts[d] = static_cast<std::uint32_t>(splitmix64(state));
+        }
+
+        estimates.push_back(weighted_sum(f, dim, points, [&](const std::size_t first, const std::size_t n,
+                                                             double *p, double *w) {
+            for (std::size_t i = 0; i < n; i++) {
+                // Точка с номером k - XOR направляющих чисел по единичным битам кода Грея k
+                const std::uint64_t k = first + i;
+                const std::uint64_t gray = k ^ (k >> 1);
+                for (int d = 0; d < dim; d++) {
+                    std::uint32_t x = shifts[d];
+                    for (int bit = 0; bit < sobol_bits && (gray >> bit) != 0; bit++) {
+                        if ((gray >> bit) & 1u) {
+                            x ^= directions[d][bit];
+                        }
+                    }
+                    const double u = (static_cast<double>(x) + 0.5) * (1.0 / 4294967296.0);
+                    p[i * dim + d] = a[d] + (b[d] - a[d]) * u;
+                }
+                w[i] = weight;
+            }
+        }));
+    }
+
+    double mean = 0.0;
+    for (const double e: estimates) {
+        mean += e;
+    }
+    mean /= replicates;
+    double variance = 0.0;
+    for (const double e: estimates) {
+        variance += (e - mean) * (e - mean);
+    }
+    variance /= replicates - 1;
+
+    qmc_estimate result;
+    result.value = mean;
+    result.error = std::sqrt(variance / replicates);
+    return result;
+}
+
+} // namespace numerics
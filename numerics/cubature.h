@@ -0,0 +1,78 @@
+#ifndef NUMERICS_CUBATURE_H
+#define NUMERICS_CUBATURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Пакетная функция многих переменных: values[i] = f(points[i * dim .. i * dim + dim - 1]).
+ *
+ * Точки передаются блоками, построчно. Блоки вычисляются параллельно
+ * в нескольких потоках, поэтому функция должна быть потокобезопасной.
+*/
+typedef std::function<void(const double *points, double *values, std::size_t count)> batch_field;
+
+/**
+ * @brief Число потоков для кубатур; 0 - по числу ядер (по умолчанию).
+*/
+void set_cubature_threads(int threads);
+
+/**
+ * @brief Тензорное произведение формул Гаусса-Лежандра на параллелепипеде [a,b].
+ *
+ * @param a нижние границы по каждой из dim = a.size() координат.
+ * @param b верхние границы.
+ * @param nodes число узлов по каждой координате (всего nodes^dim точек).
+ *
+ * Точна для многочленов степени 2*nodes - 1 по каждой переменной; число
+ * точек растет экспоненциально, так что годится для dim <= 4-5.
+*/
+double tensor_gauss(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b, int nodes);
+
+/**
+ * @brief Разреженная сетка Смоляка на вложенных формулах Кленшоу-Кертиса.
+ *
+ * @param level уровень сетки (0 - одна центральная точка).
+ *
+ * Комбинация тензорных произведений одномерных формул уровней l_i с
+ * |l| <= dim + level: число точек растет как 2^level * dim^level / level!,
+ * а не экспоненциально по dim. Узлы вложенных формул совпадают, поэтому
+ * каждая точка вычисляется один раз с суммарным весом.
+*/
+double smolyak(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b, int level);
+
+/**
+ * @brief Оценка квази-Монте-Карло: значение и его стандартная ошибка.
+*/
+struct qmc_estimate {
+    double value;
+    double error;
+};
+
+/**
+ * @brief Наибольшая размерность, для которой есть направляющие числа Соболя.
+*/
+const int sobol_max_dimension = 12;
+
+/**
+ * @brief Рандомизированный квази-Монте-Карло на последовательности Соболя.
+ *
+ * @param points число точек в одной реплике.
+ * @param replicates число независимо скрэмблированных реплик (не меньше 2).
+ * @param seed начальное значение генератора скрэмблирования.
+ *
+ * Каждая реплика - последовательность Соболя (направляющие числа Джо-Куо)
+ * со случайным линейным скрэмблированием Матушека и цифровым сдвигом.
+ * Реплики несмещенные и независимые, поэтому value - их среднее, а error -
+ * стандартная ошибка среднего. Размерность не больше sobol_max_dimension.
+*/
+qmc_estimate sobol_qmc(const batch_field &f, const std::vector<double> &a, const std::vector<double> &b,
+                       std::size_t points, int replicates, std::uint64_t seed);
+
+} // namespace numerics
+
+#endif
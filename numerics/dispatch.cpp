@@ -0,0 +1,18 @@
+#include "dispatch.h"
+
+namespace numerics {
+
+const char *active_isa() {
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(NUMERICS_NO_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return "avx512f";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return "avx2";
+    }
+#endif
+    return "default";
+}
+
+} // namespace numerics
@@ -0,0 +1,32 @@
+#ifndef NUMERICS_DISPATCH_H
+#define NUMERICS_DISPATCH_H
+
+/**
+ * @brief Выбор варианта ядра под процессор во время запуска.
+ *
+ * Функции, помеченные NUMERICS_DISPATCH, компилируются в нескольких
+ * вариантах (AVX-512, AVX2 и базовый x86-64). При загрузке программы
+ * ifunc-резолвер по cpuid выбирает самый широкий вариант, который
+ * поддерживает процессор, поэтому один бинарник использует всю ширину
+ * векторов на любой машине.
+ *
+ * Работает в GCC и Clang на x86-64 Linux; на других платформах и при
+ * -DNUMERICS_NO_DISPATCH собирается один обычный вариант.
+*/
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(NUMERICS_NO_DISPATCH)
+#define NUMERICS_DISPATCH __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define NUMERICS_DISPATCH
+#endif
+
+namespace numerics {
+
+/**
+ * @brief Название набора инструкций, вариант которого выбран на этой машине:
+ * "avx512f", "avx2" или "default".
+*/
+const char *active_isa();
+
+} // namespace numerics
+
+#endif
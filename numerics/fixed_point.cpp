@@ -0,0 +1,309 @@
+#include "fixed_point.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+
+#include "metrics.h"
+
+namespace numerics {
+
+namespace {
+
+double max_norm(const std::vector<double> &v) {
+    double norm = 0.0;
+    for (const double x: v) {
+        if (std::isnan(x)) {
+            return x;
+        }
+        norm = std::max(norm, std::fabs(x));
+    }
+    return norm;
+}
+
+bool finite(const std::vector<double> &v) {
+    for (const double x: v) {
+        if (!std::isfinite(x)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Слежение за невязкой: расходимость - рост больше чем в factor раз
+ * относительно наименьшей невязки или бесконечное значение.
+*/
+struct divergence_monitor {
+    double factor;
+    double best;
+
+    bool diverged(const double residual) {
+        if (!std::isfinite(residual)) {
+            return true;
+        }
+        best = std::min(best, residual);
+        return residual > factor * best && residual > 0.0;
+    }
+};
+
+/**
+ * @brief Коэффициенты gamma = argmin |f - sum gamma_j df_j| для столбцов df.
+ *
+ * Модифицированный Грам-Шмидт: столбец, почти линейно зависимый от более новых
+ * (норма после ортогонализации < 1e-10 от исходной), получает gamma_j = 0
+ * и помечается в dependent для удаления из истории.
+*/
+std::vector<double> least_squares(const std::deque<std::vector<double> > &df, const std::vector<double> &f,
+                                  std::vector<bool> &dependent) {
+    const std::size_t m = df.size(), n = f.size();
+    std::vector<std::vector<double> > q;
+    std::vector<std::vector<double> > r(m, std::vector<double>(m, 0.0));
+    std::vector<std::size_t> used;
+    dependent.assign(m, false);
+    // новые столбцы - первыми: при зависимости отбрасываются старые
+    for (std::size_t c = m; c-- > 0;) {
+        std::vector<double> v = df[c];
+        double original = 0.0;
+        for (const double x: v) {
+            original += x * x;
+        }
+        original = std::sqrt(original);
+        std::vector<double> coefficients(q.size());
+        for (std::size_t j = 0; j < q.size(); j++) {
+            double dot = 0.0;
+            for (std::size_t i = 0; i < n; i++) {
+                dot += q[j][i] * v[i];
+            }
+            coefficients[j] = dot;
+            for (std::size_t i = 0; i < n; i++) {
+                v[i] -= dot * q[j][i];
+            }
+        }
+        double norm = 0.0;
+        for (const double x: v) {
+            norm += x * x;
+        }
+        norm = std::sqrt(norm);
+        if (!(norm > 1e-10 * original)) {
+            dependent[c] = true;
+            continue;
+        }
+        for (std::size_t j = 0; j < q.size(); j++) {
+            r[j][q.size()] = coefficients[j];
+        }
+        r[q.size()][q.size()] = norm;
+        for (double &x: v) {
+            x /= norm;
+        }
+        q.push_back(v);
+        used.push_back(c);
+    }
+
+    // R gamma' = Q^T f, обратный ход
+    const std::size_t k = q.size();
+    std::vector<double> rhs(k), solution(k);
+    for (std::size_t j = 0; j < k; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            rhs[j] += q[j][i] * f[i];
+        }
+    }
+    for (std::size_t j = k; j-- > 0;) {
+        double s = rhs[j];
+        for (std::size_t l = j + 1; l < k; l++) {
+            s -= r[j][l] * solution[l];
+        }
+        solution[j] = s / r[j][j];
+    }
+    std::vector<double> gamma(m, 0.0);
+    for (std::size_t j = 0; j < k; j++) {
+        gamma[used[j]] = solution[j];
+    }
+    return gamma;
+}
+
+} // namespace
+
+stopping_rule stop_on_step(const double epsilon) {
+    return [epsilon](const fixed_point_progress &p) {
+        return p.step < epsilon;
+    };
+}
+
+stopping_rule stop_on_relative_step(const double epsilon) {
+    return [epsilon](const fixed_point_progress &p) {
+        return p.step <= epsilon * std::max(1.0, p.x_norm);
+    };
+}
+
+stopping_rule stop_on_residual(const double epsilon) {
+    return [epsilon](const fixed_point_progress &p) {
+        return p.residual < epsilon;
+    };
+}
+
+stopping_rule stop_on_error_estimate(const double epsilon) {
+    return [epsilon](const fixed_point_progress &p) {
+        if (p.step == 0.0) {
+            return true;
+        }
+        if (!(p.previous_step > 0.0)) {
+            return false;
+        }
+        const double q = p.step / p.previous_step;
+        return q < 1.0 && q / (1.0 - q) * p.step < epsilon;
+    };
+}
+
+fixed_point_settings fixed_point_defaults(const double epsilon, const int max_iterations) {
+    fixed_point_settings settings = {acceleration_none, max_iterations, 5, 1e8, stop_on_step(epsilon)};
+    return settings;
+}
+
+fixed_point_result fixed_point(const std::function<double(double)> &g, const double x0,
+                               const fixed_point_settings &settings) {
+    if (settings.acceleration == acceleration_anderson) {
+        const fixed_point_vector_result r = fixed_point([&g](const double *x, double *gx) {
+            gx[0] = g(x[0]);
+        }, std::vector<double>(1, x0), settings);
+        fixed_point_result result = {r.x[0], r.status, r.iterations, r.evaluations, r.residual};
+        return result;
+    }
+    if (!settings.stop || settings.max_iterations < 1) {
+        throw std::invalid_argument("fixed_point: нужны правило остановки и max_iterations >= 1");
+    }
+
+    fixed_point_result result = {x0, fixed_point_max_iterations, 0, 0, 0.0};
+    divergence_monitor monitor = {settings.divergence_factor, HUGE_VAL};
+    double x = x0, previous_step = 0.0;
+    for (int k = 0; k < settings.max_iterations; k++) {
+        result.iterations = k + 1;
+        const double gx = g(x);
+        result.evaluations++;
+        double x_new = gx;
+        if (settings.acceleration == acceleration_steffensen) {
+            // Эйткен по трем точкам x, g(x), g(g(x))
+            const double ggx = g(gx);
+            result.evaluations++;
+            const double denominator = ggx - 2.0 * gx + x;
+            const double correction = (gx - x) * (gx - x) / denominator;
+            x_new = (denominator != 0.0 && std::isfinite(correction)) ? x - correction : ggx;
+        }
+        result.residual = std::fabs(gx - x);
+        if (monitor.diverged(result.residual) || !std::isfinite(x_new)) {
+            METRICS_COUNT("numerics.fixed_point.diverged");
+            result.x = x;
+            result.status = fixed_point_diverged;
+            return result;
+        }
+
+        const fixed_point_progress progress = {k, std::fabs(x_new - x), previous_step, result.residual,
+                                               std::fabs(x_new)};
+        previous_step = progress.step;
+        x = x_new;
+        if (settings.stop(progress)) {
+            METRICS_HISTOGRAM("numerics.fixed_point.iterations", result.iterations);
+            result.x = x;
+            result.status = fixed_point_converged;
+            return result;
+        }
+    }
+    METRICS_COUNT("numerics.fixed_point.not_converged");
+    result.x = x;
+    return result;
+}
+
+fixed_point_vector_result fixed_point(const vector_map &g, const std::vector<double> &x0,
+                                      const fixed_point_settings &settings) {
+    if (settings.acceleration == acceleration_steffensen) {
+        throw std::invalid_argument("fixed_point: ускорение Стеффенсена - только для скалярных отображений");
+    }
+    if (!settings.stop || settings.max_iterations < 1 || x0.empty()
+        || (settings.acceleration == acceleration_anderson && settings.history < 1)) {
+        throw std::invalid_argument("fixed_point: нужны правило остановки, max_iterations >= 1, x0 и history >= 1");
+    }
+
+    const std::size_t n = x0.size();
+    fixed_point_vector_result result = {x0, fixed_point_max_iterations, 0, 0, 0.0};
+    divergence_monitor monitor = {settings.divergence_factor, HUGE_VAL};
+    std::vector<double> x = x0, gx(n), f(n), x_new(n), previous_g, previous_f;
+    std::deque<std::vector<double> > df, dg;
+    std::vector<bool> dependent;
+    double previous_step = 0.0, previous_residual = HUGE_VAL;
+
+    for (int k = 0; k < settings.max_iterations; k++) {
+        result.iterations = k + 1;
+        g(x.data(), gx.data());
+        result.evaluations++;
+        for (std::size_t i = 0; i < n; i++) {
+            f[i] = gx[i] - x[i];
+        }
+        result.residual = max_norm(f);
+        if (monitor.diverged(result.residual) || !finite(gx)) {
+            METRICS_COUNT("numerics.fixed_point.diverged");
+            result.x = x;
+            result.status = fixed_point_diverged;
+            return result;
+        }
+
+        x_new = gx;
+        if (settings.acceleration == acceleration_anderson) {
+            if (result.residual > previous_residual) {
+                // невязка выросла: старые направления уводят в сторону, история сбрасывается
+                METRICS_COUNT("numerics.fixed_point.anderson_restarts");
+                df.clear();
+                dg.clear();
+            } else if (!previous_g.empty()) {
+                std::vector<double> delta_f(n), delta_g(n);
+                for (std::size_t i = 0; i < n; i++) {
+                    delta_f[i] = f[i] - previous_f[i];
+                    delta_g[i] = gx[i] - previous_g[i];
+                }
+                df.push_back(delta_f);
+                dg.push_back(delta_g);
+                if (df.size() > static_cast<std::size_t>(settings.history)) {
+                    df.pop_front();
+                    dg.pop_front();
+                }
+            }
+            previous_g = gx;
+            previous_f = f;
+            previous_residual = result.residual;
+
+            if (!df.empty()) {
+                const std::vector<double> gamma = least_squares(df, f, dependent);
+                for (std::size_t j = 0; j < df.size(); j++) {
+                    for (std::size_t i = 0; i < n; i++) {
+                        x_new[i] -= gamma[j] * dg[j][i];
+                    }
+                }
+                for (std::size_t j = df.size(); j-- > 0;) {
+                    if (dependent[j]) {
+                        df.erase(df.begin() + j);
+                        dg.erase(dg.begin() + j);
+                    }
+                }
+            }
+        }
+
+        double step = 0.0;
+        for (std::size_t i = 0; i < n; i++) {
+            step = std::max(step, std::fabs(x_new[i] - x[i]));
+        }
+        const fixed_point_progress progress = {k, step, previous_step, result.residual, max_norm(x_new)};
+        previous_step = step;
+        x.swap(x_new);
+        if (settings.stop(progress)) {
+            METRICS_HISTOGRAM("numerics.fixed_point.iterations", result.iterations);
+            result.x = x;
+            result.status = fixed_point_converged;
+            return result;
+        }
+    }
+    METRICS_COUNT("numerics.fixed_point.not_converged");
+    result.x = x;
+    return result;
+}
+
+} // namespace numerics
@@ -0,0 +1,141 @@
+#ifndef NUMERICS_FIXED_POINT_H
+#define NUMERICS_FIXED_POINT_H
+
+#include <functional>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Отображение R^n -> R^n: gx[0..n-1] = g(x[0..n-1]).
+*/
+typedef std::function<void(const double *x, double *gx)> vector_map;
+
+/**
+ * @brief Ускорение итераций x_{k+1} = g(x_k).
+ *
+ * acceleration_none - простая итерация, сходится линейно со скоростью |g'|.
+ * acceleration_steffensen - только для скалярных g: по x, g(x), g(g(x)) шаг Эйткена
+ *   x - (g(x) - x)^2 / (g(g(x)) - 2 g(x) + x); сходится квадратично, производная не нужна.
+ * acceleration_anderson - смешивание Андерсона: следующее приближение - комбинация
+ *   последних history значений g, минимизирующая невязку g(x) - x по МНК.
+*/
+enum fixed_point_acceleration {
+    acceleration_none,
+    acceleration_steffensen,
+    acceleration_anderson,
+};
+
+enum fixed_point_status {
+    fixed_point_converged,
+    fixed_point_max_iterations,
+    fixed_point_diverged,
+};
+
+/**
+ * @brief Состояние после итерации k для правила остановки.
+ *
+ * step = |x_{k+1} - x_k|, residual = |g(x_k) - x_k|, x_norm = |x_{k+1}|
+ * (для векторов - максимум модулей компонент); previous_step - step предыдущей
+ * итерации (0 на первой).
+*/
+struct fixed_point_progress {
+    int iteration;
+    double step;
+    double previous_step;
+    double residual;
+    double x_norm;
+};
+
+/**
+ * @brief Правило остановки: true - приближение x_{k+1} принимается.
+*/
+typedef std::function<bool(const fixed_point_progress &)> stopping_rule;
+
+/**
+ * @brief |x_{k+1} - x_k| < epsilon - классический критерий простой итерации.
+*/
+stopping_rule stop_on_step(double epsilon);
+
+/**
+ * @brief |x_{k+1} - x_k| <= epsilon * max(1, |x_{k+1}|).
+*/
+stopping_rule stop_on_relative_step(double epsilon);
+
+/**
+ * @brief |g(x_k) - x_k| < epsilon.
+*/
+stopping_rule stop_on_residual(double epsilon);
+
+/**
+ * @brief Апостериорная оценка погрешности q / (1 - q) |x_{k+1} - x_k| < epsilon,
+ * где q - отношение двух последних шагов (оценка коэффициента сжатия).
+ *
+ * В отличие от stop_on_step не останавливает медленно сходящиеся итерации
+ * (q близко к 1) раньше времени.
+*/
+stopping_rule stop_on_error_estimate(double epsilon);
+
+/**
+ * @brief Настройки итераций.
+ *
+ * history - глубина истории Андерсона; divergence_factor - итерации считаются
+ * расходящимися, если невязка выросла больше чем в divergence_factor раз
+ * по сравнению с наименьшей (или стала бесконечной); stop - правило остановки.
+*/
+struct fixed_point_settings {
+    fixed_point_acceleration acceleration;
+    int max_iterations;
+    int history;
+    double divergence_factor;
+    stopping_rule stop;
+};
+
+/**
+ * @brief Настройки по умолчанию: без ускорения, stop_on_step(epsilon).
+*/
+fixed_point_settings fixed_point_defaults(double epsilon, int max_iterations = 1000);
+
+/**
+ * @brief Результат итераций: приближение, причина остановки, число итераций,
+ * число вычислений g и последняя невязка |g(x) - x|.
+*/
+struct fixed_point_result {
+    double x;
+    fixed_point_status status;
+    int iterations;
+    int evaluations;
+    double residual;
+};
+
+struct fixed_point_vector_result {
+    std::vector<double> x;
+    fixed_point_status status;
+    int iterations;
+    int evaluations;
+    double residual;
+};
+
+/**
+ * @brief Неподвижная точка скалярного отображения g, начиная с x0.
+ *
+ * acceleration_anderson для скаляра - то же, что для вектора длины 1 (метод секущих
+ * при history = 1).
+*/
+fixed_point_result fixed_point(const std::function<double(double)> &g, double x0,
+                               const fixed_point_settings &settings);
+
+/**
+ * @brief Неподвижная точка отображения R^n -> R^n, n = x0.size().
+ *
+ * acceleration_steffensen для векторов не поддерживается (std::invalid_argument).
+ * Андерсон решает задачу МНК на history столбцах QR-разложением (Грам-Шмидт);
+ * почти линейно зависимые старые столбцы отбрасываются, а при росте невязки
+ * история сбрасывается.
+*/
+fixed_point_vector_result fixed_point(const vector_map &g, const std::vector<double> &x0,
+                                      const fixed_point_settings &settings);
+
+} // namespace numerics
+
+#endif
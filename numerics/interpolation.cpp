@@ -0,0 +1,111 @@
+#include "interpolation.h"
+
+#include "dispatch.h"
+
+namespace numerics {
+
+namespace {
+
+/**
+ * @brief Ядро пакетного полинома Ньютона: nodes и coefficients - плоские массивы.
+*/
+NUMERICS_DISPATCH
+void newton_kernel(const double *points, double *out, const std::size_t count,
+                   const double *nodes, const double *coefficients, const int n) {
+    for (std::size_t k = 0; k < count; k++) {
+        const double x_point = points[k];
+        double result = coefficients[0];
+        double product = 1.0;
+        for (int i = 1; i < n; i++) {
+            product *= (x_point - nodes[i - 1]);
+            result += coefficients[i] * product;
+        }
+        out[k] = result;
+    }
+}
+
+/**
+ * @brief Ядро полинома Ньютона по наборам: c - значения в узлах, наборы подряд
+ * по count (заменяются разделенными разностями), products[j] = (x - x_0)...(x - x_{j-1}).
+*/
+NUMERICS_DISPATCH
+void newton_sets_kernel(double *c, double *out, const std::size_t count, const double *nodes,
+                        const double *products, const int n) {
+    for (int k = 1; k < n; k++) {
+        for (int j = n - 1; j >= k; j--) {
+            const double h = nodes[j] - nodes[j - k];
+            double *cj = c + j * count;
+            const double *previous = c + (j - 1) * count;
+            for (std::size_t i = 0; i < count; i++) {
+                cj[i] = (cj[i] - previous[i]) / h;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        out[i] = c[i];
+    }
+    for (int j = 1; j < n; j++) {
+        const double *cj = c + j * count;
+        for (std::size_t i = 0; i < count; i++) {
+            out[i] += cj[i] * products[j];
+        }
+    }
+}
+
+} // namespace
+
+std::vector<std::vector<double> > divided_differences(const std::vector<double> &x,
+                                                      const std::vector<double> &y) {
+    int n = x.size();
+    std::vector<std::vector<double> > diff(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; i++) {
+        diff[i][0] = y[i];
+    }
+    for (int j = 1; j < n; j++) {
+        for (int i = 0; i < n - j; i++) {
+            diff[i][j] = (diff[i + 1][j - 1] - diff[i][j - 1]) / (x[i + j] - x[i]);
+        }
+    }
+    return diff;
+}
+
+double newton_interpolation(const double x_point, const std::vector<double> &x,
+                            const std::vector<std::vector<double> > &diff) {
+    double result;
+    newton_kernel(&x_point, &result, 1, x.data(), diff[0].data(), x.size());
+    return result;
+}
+
+void newton_interpolation(const double *points, double *out, const std::size_t count,
+                          const std::vector<double> &x, const std::vector<std::vector<double> > &diff) {
+    newton_kernel(points, out, count, x.data(), diff[0].data(), x.size());
+}
+
+void newton_interpolation(const double x_point, const std::vector<double> &x, const double *values, double *out,
+                          const std::size_t count) {
+    const int n = x.size();
+    std::vector<double> products(n, 1.0);
+    for (int j = 1; j < n; j++) {
+        products[j] = products[j - 1] * (x_point - x[j - 1]);
+    }
+    std::vector<double> c(values, values + n * count);
+    newton_sets_kernel(c.data(), out, count, x.data(), products.data(), n);
+}
+
+double linear_spline(const double x_point, const std::vector<double> &x, const std::vector<double> &y) {
+    int n = x.size();
+    int interval = 0;
+    for (int i = 0; i < n - 1; i++) {
+        if (x_point >= x[i] && x_point <= x[i + 1]) {
+            interval = i;
+            break;
+        }
+    }
+    if (x_point > x[n - 1]) {
+        interval = n - 2;
+    }
+    return y[interval] + (y[interval + 1] - y[interval]) * (x_point - x[interval]) / (
+               x[interval + 1] - x[interval]);
+}
+
+} // namespace numerics
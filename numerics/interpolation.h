@@ -0,0 +1,64 @@
+#ifndef NUMERICS_INTERPOLATION_H
+#define NUMERICS_INTERPOLATION_H
+
+#include <cstddef>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Функция создания таблицы разделенных разностей.
+ *
+ * diff[i][j] - разделенная разность f[x_i, ..., x_{i+j}],
+ * коэффициенты полинома Ньютона лежат в строке diff[0].
+*/
+std::vector<std::vector<double> > divided_differences(const std::vector<double> &x,
+                                                      const std::vector<double> &y);
+
+/**
+ * @brief Интерполяционный полином Ньютона.
+ *
+ * @param x_point точка, в которой вычисляем полином.
+ * @param x вектор узлов.
+ * @param diff таблица разделенных разностей.
+ *
+ * product накапливает произведение (x - x_0)(x - x_1)...,
+ * результат - сумма diff[0][i] * product.
+*/
+double newton_interpolation(double x_point, const std::vector<double> &x,
+                            const std::vector<std::vector<double> > &diff);
+
+/**
+ * @brief Пакетная версия: out[i] = newton_interpolation(points[i], x, diff).
+*/
+void newton_interpolation(const double *points, double *out, std::size_t count,
+                          const std::vector<double> &x, const std::vector<std::vector<double> > &diff);
+
+/**
+ * @brief Полином Ньютона в одной точке для многих наборов значений в узлах x.
+ *
+ * values[j * count + i] - значение в узле j набора i; out[i] совпадает
+ * с newton_interpolation(x_point, x, divided_differences(x, набор i)).
+ * Разделенные разности считаются на месте сразу для всех наборов, и внутренние
+ * циклы по наборам векторизуются - так полином встает в пакетную модель
+ * propagate_uncertainty (uncertainty.h).
+*/
+void newton_interpolation(double x_point, const std::vector<double> &x, const double *values, double *out,
+                          std::size_t count);
+
+/**
+ * @brief Линейная сплайн-интерполяция.
+ *
+ * @param x_point точка, в которой вычисляем значение.
+ * @param x вектор узлов.
+ * @param y вектор значений.
+ *
+ * Внутри данных - линейная интерполяция на интервале, содержащем x_point;
+ * правее последнего узла продолжается наклон последнего интервала.
+ * Формула: y_i + (y_{i+1} - y_i) * (x - x_i) / (x_{i+1} - x_i).
+*/
+double linear_spline(double x_point, const std::vector<double> &x, const std::vector<double> &y);
+
+} // namespace numerics
+
+#endif
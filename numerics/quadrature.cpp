@@ -0,0 +1,213 @@
+#include "quadrature.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "compensated.h"
+#include "dispatch.h"
+#include "metrics.h"
+
+namespace numerics {
+
+namespace {
+
+const long block_size = 512;
+
+NUMERICS_DISPATCH
+void fill_grid(double *x, const double x0, const double dx, const long k0, const long m) {
+    for (long i = 0; i < m; i++) {
+        x[i] = x0 + static_cast<double>(k0 + i) * dx;
+    }
+}
+
+/**
+ * @brief Компенсированная сумма блока в 8 независимых накопителей.
+ *
+ * Без -ffast-math компилятор не переставляет сложения сам, а так цикл
+ * ложится на векторные регистры. Каждый накопитель хранит сумму и ошибку
+ * округления (two_sum без ветвлений), поэтому знакопеременные слагаемые
+ * не теряют младшие разряды.
+*/
+NUMERICS_DISPATCH
+double_double block_sum(const double *y, const long m) {
+    double sums[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    double errors[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    long i = 0;
+    for (; i + 8 <= m; i += 8) {
+        for (int j = 0; j < 8; j++) {
+            const double t = sums[j] + y[i + j];
+            const double bb = t - sums[j];
+            errors[j] += (sums[j] - (t - bb)) + (y[i + j] - bb);
+            sums[j] = t;
+        }
+    }
+    double_double sum = make_double_double(0.0);
+    for (; i < m; i++) {
+        sum = sum + y[i];
+    }
+    for (int j = 0; j < 8; j++) {
+        const double_double lane = {sums[j], errors[j]};
+        sum = sum + lane;
+    }
+    return sum;
+}
+
+/**
+ * @brief Значение f в одной точке через пакетный интерфейс.
+*/
+double point_value(const batch_function &f, const double x) {
+    double y;
+    f(&x, &y, 1);
+    return y;
+}
+
+} // namespace
+
+double grid_sum(const batch_function &f, const double x0, const double dx, const long m) {
+    METRICS_ADD("numerics.quadrature.grid_points", m);
+    double x[block_size];
+    double y[block_size];
+    double_double sum = make_double_double(0.0);
+
+    for (long k = 0; k < m; k += block_size) {
+        const long count = (m - k < block_size) ? m - k : block_size;
+        fill_grid(x, x0, dx, k, count);
+        f(x, y, count);
+        sum = sum + block_sum(y, count);
+    }
+    return to_double(sum);
+}
+
+double rectangle_method(const batch_function &f, const double a, const double b, const int n) {
+    const double h = (b - a) / n;
+    return grid_sum(f, a + 0.5 * h, h, n) * h;
+}
+
+double trapezoidal_method(const batch_function &f, const double a, const double b, const int n) {
+    const double h = (b - a) / n;
+    const double sum = 0.5 * (point_value(f, a) + point_value(f, b)) + grid_sum(f, a + h, h, n - 1);
+    return sum * h;
+}
+
+double simpson_method(const batch_function &f, const double a, const double b, int n) {
+    if (n % 2 != 0) n++;
+    const double h = (b - a) / n;
+
+    const double odd = grid_sum(f, a + h, 2.0 * h, n / 2);
+    const double even = grid_sum(f, a + 2.0 * h, 2.0 * h, n / 2 - 1);
+    const double sum = point_value(f, a) + point_value(f, b) + 4.0 * odd + 2.0 * even;
+    return sum * h / 3.0;
+}
+
+double three_eights_method(const batch_function &f, const double a, const double b, int n) {
+    if (n % 3 != 0) n += (3 - n % 3);
+    const double h = (b - a) / n;
+
+    const double interior = grid_sum(f, a + h, h, n - 1);
+    const double multiples_of_3 = grid_sum(f, a + 3.0 * h, 3.0 * h, n / 3 - 1);
+    const double sum = point_value(f, a) + point_value(f, b)
+                       + 3.0 * (interior - multiples_of_3) + 2.0 * multiples_of_3;
+    return sum * h * 3.0 / 8.0;
+}
+
+quadrature_rule gauss_legendre_rule(const int n) {
+    if (n < 1) {
+        throw std::invalid_argument("gauss_legendre_rule: нужен хотя бы один узел");
+    }
+    quadrature_rule rule;
+    rule.nodes.resize(n);
+    rule.weights.resize(n);
+    for (int i = 0; i < (n + 1) / 2; i++) {
+        double x = cos(M_PI * (i + 0.75) / (n + 0.5));
+        double dp = 0.0;
+        for (int iteration = 0; iteration < 100; iteration++) {
+            // P_n(x) и P_n'(x) по трехчленной рекуррентной формуле
+            double p0 = 1.0;
+            double p1 = x;
+            for (int k = 2; k <= n; k++) {
+                const double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                p0 = p1;
+                p1 = p2;
+            }
+            const double pn = n == 1 ? x : p1;
+            const double pn_1 = n == 1 ? 1.0 : p0;
+            dp = n * (x * pn - pn_1) / (x * x - 1.0);
+            const double dx = pn / dp;
+            x -= dx;
+            if (fabs(dx) < 1e-16) {
+                break;
+            }
+        }
+        if (n == 1) {
+            x = 0.0;
+            dp = 1.0;
+        }
+        rule.nodes[i] = -x;
+        rule.nodes[n - 1 - i] = x;
+        rule.weights[i] = rule.weights[n - 1 - i] = 2.0 / ((1.0 - x * x) * dp * dp);
+    }
+    return rule;
+}
+
+double gauss_legendre(const batch_function &f, const double a, const double b, const int nodes) {
+    if (nodes < 2 || nodes > 4) {
+        const quadrature_rule rule = gauss_legendre_rule(nodes);
+        const double scale = (b - a) / 2.0;
+        std::vector<double> x(nodes);
+        std::vector<double> y(nodes);
+        for (int i = 0; i < nodes; i++) {
+            x[i] = (a + b) / 2.0 + scale * rule.nodes[i];
+        }
+        f(x.data(), y.data(), nodes);
+        METRICS_ADD("numerics.quadrature.gauss_points", nodes);
+        double_double sum = make_double_double(0.0);
+        for (int i = 0; i < nodes; i++) {
+            sum = sum + rule.weights[i] * y[i];
+        }
+        return to_double(sum) * scale;
+    }
+
+    double t[4];
+    double w[4];
+    if (nodes == 2) {
+        t[0] = -1.0 / sqrt(3.0);
+        t[1] = 1.0 / sqrt(3.0);
+        w[0] = w[1] = 1.0;
+    } else if (nodes == 3) {
+        t[0] = -sqrt(3.0 / 5.0);
+        t[1] = 0.0;
+        t[2] = sqrt(3.0 / 5.0);
+        w[0] = w[2] = 5.0 / 9.0;
+        w[1] = 8.0 / 9.0;
+    } else if (nodes == 4) {
+        t[0] = -sqrt(3.0 / 7.0 + 2.0 / 7.0 * sqrt(6.0 / 5.0));
+        t[1] = -sqrt(3.0 / 7.0 - 2.0 / 7.0 * sqrt(6.0 / 5.0));
+        t[2] = -t[1];
+        t[3] = -t[0];
+        w[0] = w[3] = (18.0 - sqrt(30.0)) / 36.0;
+        w[1] = w[2] = (18.0 + sqrt(30.0)) / 36.0;
+    }
+
+    const double scale = (b - a) / 2.0;
+    const double shift = (a + b) / 2.0;
+
+    double x[4];
+    double y[4];
+    for (int i = 0; i < nodes; i++) {
+        x[i] = shift + scale * t[i];
+    }
+    f(x, y, nodes);
+    METRICS_ADD("numerics.quadrature.gauss_points", nodes);
+
+    double sum = 0.0;
+    for (int i = 0; i < nodes; i++) {
+        sum += w[i] * y[i];
+    }
+    return sum * scale;
+}
+
+double runge_error(const double I_h, const double I_h2, const int p) {
+    return fabs(I_h - I_h2) / (pow(2, p) - 1);
+}
+
+} // namespace numerics
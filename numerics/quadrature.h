@@ -0,0 +1,103 @@
+#ifndef NUMERICS_QUADRATURE_H
+#define NUMERICS_QUADRATURE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Пакетная подынтегральная функция: y[i] = f(x[i]) для i < n.
+ *
+ * Квадратуры передают узлы блоками, поэтому функция может считать
+ * весь блок одним векторизованным циклом.
+*/
+typedef std::function<void(const double *x, double *y, std::size_t n)> batch_function;
+
+/**
+ * @brief Сумма f(x0 + k * dx) по k = 0..m-1.
+ *
+ * Общее ядро составных квадратур: узлы генерируются и суммируются
+ * блоками, горячие циклы собраны в нескольких вариантах ISA. Сумма
+ * компенсированная (double-double, см. compensated.h): сотни тысяч
+ * знакопеременных значений f не накапливают ошибку округления.
+*/
+double grid_sum(const batch_function &f, double x0, double dx, long m);
+
+/**
+ * @brief Функция метода средних прямоугольников.
+ *
+ * @param f подынтегральная функция.
+ * @param a нижний предел интегрирования.
+ * @param b верхний предел интегрирования.
+ * @param n количество разбиений отрезка [a,b].
+ * @return Приближенное значение интеграла.
+ *
+ * Разбивает отрезок на n равных частей, в каждом подинтервале берет
+ * значение функции в средней точке и суммирует площади прямоугольников.
+*/
+double rectangle_method(const batch_function &f, double a, double b, int n);
+
+/**
+ * @brief Функция метода трапеций.
+ *
+ * Веса: концы отрезка 0.5, внутренние узлы 1.
+*/
+double trapezoidal_method(const batch_function &f, double a, double b, int n);
+
+/**
+ * @brief Функция метода Симпсона.
+ *
+ * n округляется вверх до четного. Веса 1-4-2-4-2-...-4-1: нечетные
+ * и четные внутренние узлы суммируются отдельно.
+*/
+double simpson_method(const batch_function &f, double a, double b, int n);
+
+/**
+ * @brief Функция правила 3/8.
+ *
+ * n округляется вверх до кратного 3. Веса 1-3-3-2-3-3-2-...-3-3-1.
+*/
+double three_eights_method(const batch_function &f, double a, double b, int n);
+
+/**
+ * @brief Узлы и веса квадратурной формулы на [-1,1].
+*/
+struct quadrature_rule {
+    std::vector<double> nodes;
+    std::vector<double> weights;
+};
+
+/**
+ * @brief Формула Гаусса-Лежандра с n узлами на [-1,1].
+ *
+ * Узлы - корни P_n, найденные методом Ньютона от чебышевских приближений;
+ * веса w = 2 / ((1 - x^2) P_n'(x)^2). При n < 1 выбрасывает std::invalid_argument.
+*/
+quadrature_rule gauss_legendre_rule(int n);
+
+/**
+ * @brief Квадратура Гаусса-Лежандра на всем отрезке [a,b].
+ *
+ * @param nodes число узлов (точна для многочленов степени 2*nodes - 1).
+ *
+ * Узлы - корни многочлена Лежандра на [-1,1], линейно перенесенные на [a,b].
+ * Для 2, 3 и 4 узлов используются явные формулы, для остальных - gauss_legendre_rule.
+ * При nodes < 1 выбрасывает std::invalid_argument.
+*/
+double gauss_legendre(const batch_function &f, double a, double b, int nodes);
+
+/**
+ * @brief Функция правила Рунге для оценки погрешности.
+ *
+ * @param I_h значение интеграла на сетке с шагом h.
+ * @param I_h2 значение интеграла на сетке с шагом h/2.
+ * @param p порядок точности метода.
+ * @return e = |I_h - I_h2| / (2^p - 1).
+*/
+double runge_error(double I_h, double I_h2, int p);
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,46 @@
+#include "roots.h"
+
+#include <cmath>
+
+#include "fixed_point.h"
+#include "metrics.h"
+
+namespace numerics {
+
+double newton_method(const scalar_function &F, const scalar_function &dF,
+                     const double x0, const double epsilon, const int max_iterations) {
+    double x = x0;
+
+    for (int i = 0; i < max_iterations; i++) {
+        double f = F(x);
+        double df = dF(x);
+        METRICS_COUNT("numerics.newton_method.steps");
+
+        if (std::fabs(df) < 1e-12) {
+            METRICS_COUNT("numerics.newton_method.flat_derivative");
+            break;
+        }
+
+        double x_new = x - f / df;
+
+        if (std::fabs(x_new - x) < epsilon) {
+            METRICS_HISTOGRAM("numerics.newton_method.iterations", i + 1);
+            METRICS_HISTOGRAM("numerics.newton_method.residual", std::fabs(f));
+            return x_new;
+        }
+
+        x = x_new;
+    }
+
+    METRICS_COUNT("numerics.newton_method.not_converged");
+    return x;
+}
+
+double simple_iteration(const scalar_function &g, const double x0, const double epsilon,
+                        const int max_iterations, int &iterations) {
+    const fixed_point_result result = fixed_point(g, x0, fixed_point_defaults(epsilon, max_iterations));
+    iterations = result.iterations;
+    return result.x;
+}
+
+} // namespace numerics
@@ -0,0 +1,41 @@
+#ifndef NUMERICS_ROOTS_H
+#define NUMERICS_ROOTS_H
+
+#include <functional>
+
+namespace numerics {
+
+typedef std::function<double(double)> scalar_function;
+
+/**
+ * @brief Функция метода Ньютона для уравнения F(x) = 0.
+ *
+ * @param F функция.
+ * @param dF производная функции.
+ * @param x0 начальное приближение.
+ * @param epsilon требуемая точность: итерации останавливаются при |x_new - x| < epsilon.
+ * @param max_iterations максимальное число итераций.
+ *
+ * Если |F'(x)| < 1e-12, итерации прекращаются и возвращается текущее x.
+*/
+double newton_method(const scalar_function &F, const scalar_function &dF,
+                     double x0, double epsilon, int max_iterations);
+
+/**
+ * @brief Функция метода простой итерации x_{n+1} = g(x_n).
+ *
+ * @param g итерационная функция.
+ * @param x0 начальное приближение.
+ * @param epsilon требуемая точность: итерации останавливаются при |x_new - x| < epsilon.
+ * @param max_iterations максимальное число итераций.
+ * @param iterations число выполненных итераций (выходной параметр).
+ *
+ * Сокращение для fixed_point(g, x0, fixed_point_defaults(epsilon, max_iterations))
+ * (fixed_point.h): при расходимости итерации прекращаются раньше max_iterations.
+*/
+double simple_iteration(const scalar_function &g, double x0, double epsilon,
+                        int max_iterations, int &iterations);
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,407 @@
+#include "sampling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "metrics.h"
+
+namespace numerics {
+
+namespace {
+
+/**
+ * @brief Состояние адаптивной выборки: функция, масштабы кривых и выходная кривая.
+*/
+struct sampler {
+    const curve_function &f;
+    const int dims;
+    const sampling_settings &settings;
+    std::vector<double> lo, hi, height;
+    sampled_curve &out;
+
+    double clamp(const int d, const double v) const {
+        return std::min(hi[d], std::max(lo[d], v));
+    }
+
+    void emit(const double x, const double *y) {
+        out.x.push_back(x);
+        out.y.insert(out.y.end(), y, y + dims);
+    }
+
+    /**
+     * @brief Точки интервала (xa, xb]: середины по мере надобности, затем xb.
+    */
+    void refine(const double xa, const double *ya, const double xb, const double *yb, const int depth) {
+        const double xm = 0.5 * (xa + xb);
+        std::vector<double> ym(dims);
+        f(xm, ym.data());
+        METRICS_COUNT("numerics.sampling.evaluations");
+
+        bool split = false;
+        for (int d = 0; d < dims && !split; d++) {
+            const bool na = std::isnan(ya[d]), nb = std::isnan(yb[d]), nm = std::isnan(ym[d]);
+            if (na && nb) {
+                // кривая не определена на всем интервале или только внутри него: не видно
+                continue;
+            }
+            if (na || nb || nm) {
+                // граница области определения: уточняется до последнего уровня
+                split = true;
+                continue;
+            }
+            const double chord = 0.5 * (clamp(d, ya[d]) + clamp(d, yb[d]));
+            split = std::fabs(clamp(d, ym[d]) - chord) > settings.tolerance * height[d];
+        }
+
+        if (split && depth < settings.max_depth) {
+            refine(xa, ya, xm, ym.data(), depth + 1);
+            refine(xm, ym.data(), xb, yb, depth + 1);
+            return;
+        }
+        if (split) {
+            // Последний уровень: полюс, если значения по разные стороны графика
+            // отличаются больше чем на половину его высоты, а середина вне их диапазона
+            bool pole = false;
+            for (int d = 0; d < dims; d++) {
+                const double low = std::min(ya[d], yb[d]), high = std::max(ya[d], yb[d]);
+                if (high - low > 0.5 * height[d] && (ym[d] > high || ym[d] < low)) {
+                    ym[d] = std::numeric_limits<double>::quiet_NaN();
+                    pole = true;
+                }
+            }
+            if (pole) {
+                METRICS_COUNT("numerics.sampling.poles");
+            } else {
+                METRICS_COUNT("numerics.sampling.unresolved");
+            }
+            emit(xm, ym.data());
+        }
+        emit(xb, yb);
+    }
+};
+
+/**
+ * @brief Масштабы для прореживания: x и каждая кривая приводятся к [0, 1]
+ * по конечным значениям, чтобы площади треугольников разных кривых были сравнимы.
+*/
+struct scales {
+    double x0, x_scale;
+    std::vector<double> y0, y_scale;
+
+    explicit scales(const sampled_curve &curve) : y0(curve.dims), y_scale(curve.dims) {
+        const std::size_t n = curve.size();
+        x0 = curve.x.front();
+        x_scale = curve.x.back() > curve.x.front() ? 1.0 / (curve.x.back() - curve.x.front()) : 1.0;
+        for (int d = 0; d < curve.dims; d++) {
+            double low = std::numeric_limits<double>::infinity(), high = -low;
+            for (std::size_t i = 0; i < n; i++) {
+                const double v = curve.y[i * curve.dims + d];
+                if (std::isfinite(v)) {
+                    low = std::min(low, v);
+                    high = std::max(high, v);
+                }
+            }
+            y0[d] = std::isfinite(low) ? low : 0.0;
+            y_scale[d] = high > low ? 1.0 / (high - low) : 1.0;
+        }
+    }
+};
+
+/**
+ * @brief Участки [begin, end) с одинаковым набором определенных кривых:
+ * прореживание не должно сдвигать границы разрывов.
+*/
+std::vector<std::pair<std::size_t, std::size_t> > defined_runs(const sampled_curve &curve) {
+    std::vector<std::pair<std::size_t, std::size_t> > runs;
+    auto pattern = [&curve](const std::size_t i) {
+        std::vector<bool> p(curve.dims);
+        for (int d = 0; d < curve.dims; d++) {
+            p[d] = std::isfinite(curve.y[i * curve.dims + d]);
+        }
+        return p;
+    };
+    std::size_t begin = 0;
+    std::vector<bool> current = pattern(0);
+    for (std::size_t i = 1; i < curve.size(); i++) {
+        std::vector<bool> next = pattern(i);
+        if (next != current) {
+            runs.emplace_back(begin, i);
+            begin = i;
+            current.swap(next);
+        }
+    }
+    runs.emplace_back(begin, curve.size());
+    return runs;
+}
+
+/**
+ * @brief Сколько точек оставить на каждом участке: пропорционально длине,
+ * но не меньше двух (концы участка) и не больше самого участка.
+ *
+ * Если так набирается больше target точек (много коротких участков между NaN),
+ * бюджеты срезаются общим потолком - точки снимаются с самых больших участков;
+ * при потолке 1 от участка остается первая точка, при 0 участок пропадает.
+ * Остаток до target раздается срезанным участкам равномерно по длине кривой.
+*/
+std::vector<std::size_t> run_budgets(const std::vector<std::pair<std::size_t, std::size_t> > &runs,
+                                     const std::size_t total, const std::size_t target) {
+    std::vector<std::size_t> budgets;
+    std::size_t sum = 0, largest = 0;
+    for (const auto &run: runs) {
+        const std::size_t length = run.second - run.first;
+        const std::size_t share = static_cast<std::size_t>(static_cast<double>(target) * length / total);
+        budgets.push_back(std::min(length, std::max<std::size_t>(2, share)));
+        sum += budgets.back();
+        largest = std::max(largest, budgets.back());
+    }
+    if (sum <= target) {
+        return budgets;
+    }
+
+    auto capped_sum = [&budgets](const std::size_t cap) {
+        std::size_t s = 0;
+        for (const std::size_t b: budgets) {
+            s += std::min(b, cap);
+        }
+        return s;
+    };
+    // наибольший потолок, при котором сумма не больше target
+    std::size_t low = 0, high = largest;
+    while (low < high) {
+        const std::size_t cap = (low + high + 1) / 2;
+        if (capped_sum(cap) <= target) {
+            low = cap;
+        } else {
+            high = cap - 1;
+        }
+    }
+    std::size_t cut = 0;
+    for (const std::size_t b: budgets) {
+        cut += b > low ? 1 : 0;
+    }
+    const std::size_t extra = target - capped_sum(low);
+    std::size_t j = 0;
+    for (std::size_t &b: budgets) {
+        if (b > low) {
+            b = low + ((j + 1) * extra / cut - j * extra / cut);
+            j++;
+        }
+    }
+    return budgets;
+}
+
+sampled_curve select(const sampled_curve &curve, const std::vector<std::size_t> &indices) {
+    sampled_curve result = {curve.dims, {}, {}};
+    result.x.reserve(indices.size());
+    result.y.reserve(indices.size() * curve.dims);
+    for (const std::size_t i: indices) {
+        result.x.push_back(curve.x[i]);
+        result.y.insert(result.y.end(), curve.y.begin() + i * curve.dims, curve.y.begin() + (i + 1) * curve.dims);
+    }
+    return result;
+}
+
+void check_curve(const sampled_curve &curve) {
+    if (curve.dims < 1 || curve.y.size() != curve.x.size() * curve.dims) {
+        throw std::invalid_argument("размер y не равен dims * размер x");
+    }
+}
+
+} // namespace
+
+sampled_curve adaptive_sample(const curve_function &f, const int dims, const double a, const double b,
+                              const std::vector<view_range> &views, const sampling_settings &settings) {
+    if (dims < 1 || !(a < b) || settings.initial_intervals < 1 || settings.max_depth < 0
+        || !(settings.tolerance > 0)) {
+        throw std::invalid_argument("некорректные параметры адаптивной выборки");
+    }
+    if (!views.empty() && views.size() != static_cast<std::size_t>(dims)) {
+        throw std::invalid_argument("число диапазонов графика не равно числу кривых");
+    }
+    METRICS_TIMER("numerics.adaptive_sample");
+
+    const int n = settings.initial_intervals;
+    std::vector<double> grid_x(n + 1), grid_y((n + 1) * dims);
+    for (int i = 0; i <= n; i++) {
+        grid_x[i] = i == n ? b : a + (b - a) * i / n;
+        f(grid_x[i], &grid_y[i * dims]);
+    }
+    METRICS_ADD("numerics.sampling.evaluations", n + 1);
+
+    sampled_curve curve = {dims, {}, {}};
+    // Прижимаются к краям только заданные диапазоны: диапазон начальной сетки
+    // задает лишь масштаб, и вершины между ее узлами не срезаются
+    const double infinity = std::numeric_limits<double>::infinity();
+    sampler s = {f, dims, settings, std::vector<double>(dims, -infinity), std::vector<double>(dims, infinity),
+                 std::vector<double>(dims), curve};
+    for (int d = 0; d < dims; d++) {
+        if (!views.empty() && views[d].lo < views[d].hi) {
+            s.lo[d] = views[d].lo;
+            s.hi[d] = views[d].hi;
+            s.height[d] = views[d].hi - views[d].lo;
+            continue;
+        }
+        double low = infinity, high = -infinity;
+        for (int i = 0; i <= n; i++) {
+            const double v = grid_y[i * dims + d];
+            if (std::isfinite(v)) {
+                low = std::min(low, v);
+                high = std::max(high, v);
+            }
+        }
+        if (!(low < high)) {
+            // постоянная или нигде не определенная кривая: любой масштаб
+            low = 0.0;
+            high = 1.0;
+        }
+        s.height[d] = high - low;
+    }
+
+    s.emit(grid_x[0], &grid_y[0]);
+    for (int i = 0; i < n; i++) {
+        s.refine(grid_x[i], &grid_y[i * dims], grid_x[i + 1], &grid_y[(i + 1) * dims], 0);
+    }
+    METRICS_HISTOGRAM("numerics.sampling.points", curve.size());
+    return curve;
+}
+
+sampled_curve lttb_decimate(const sampled_curve &curve, const std::size_t target) {
+    check_curve(curve);
+    if (curve.size() <= std::max<std::size_t>(target, 2)) {
+        return curve;
+    }
+    const int dims = curve.dims;
+    const scales scale(curve);
+    auto px = [&](const std::size_t i) {
+        return (curve.x[i] - scale.x0) * scale.x_scale;
+    };
+    auto py = [&](const std::size_t i, const int d) {
+        return (curve.y[i * dims + d] - scale.y0[d]) * scale.y_scale[d];
+    };
+
+    const std::vector<std::pair<std::size_t, std::size_t> > runs = defined_runs(curve);
+    const std::vector<std::size_t> budgets = run_budgets(runs, curve.size(), target);
+    std::vector<std::size_t> kept;
+    std::vector<double> average(dims);
+    for (std::size_t r = 0; r < runs.size(); r++) {
+        const std::size_t first = runs[r].first, last = runs[r].second - 1, m = budgets[r];
+        if (m < 2) {
+            if (m == 1) {
+                kept.push_back(first);
+            }
+            continue;
+        }
+        if (m >= last - first + 1) {
+            for (std::size_t i = first; i <= last; i++) {
+                kept.push_back(i);
+            }
+            continue;
+        }
+        // m - 2 корзины между концами участка
+        const double bucket = static_cast<double>(last - first - 1) / (m - 2);
+        auto bucket_begin = [&](const std::size_t k) {
+            return std::min(last, first + 1 + static_cast<std::size_t>(k * bucket));
+        };
+        kept.push_back(first);
+        std::size_t previous = first;
+        for (std::size_t k = 0; k + 2 < m; k++) {
+            const std::size_t begin = bucket_begin(k), end = std::max(begin + 1, bucket_begin(k + 1));
+            // среднее следующей корзины; для последней - конец участка
+            const std::size_t next_begin = std::min(end, last);
+            const std::size_t next_end = k + 3 < m ? std::max(next_begin + 1, bucket_begin(k + 2)) : last + 1;
+            const std::size_t count = next_end - next_begin;
+            double average_x = 0.0;
+            std::fill(average.begin(), average.end(), 0.0);
+            for (std::size_t j = next_begin; j < next_end; j++) {
+                average_x += px(j);
+                for (int d = 0; d < dims; d++) {
+                    average[d] += std::isfinite(curve.y[j * dims + d]) ? py(j, d) : 0.0;
+                }
+            }
+            average_x /= count;
+            for (double &v: average) {
+                v /= count;
+            }
+
+            std::size_t best = begin;
+            double best_area = -1.0;
+            for (std::size_t j = begin; j < end; j++) {
+                // сумма площадей треугольников по определенным кривым
+                double area = 0.0;
+                for (int d = 0; d < dims; d++) {
+                    if (std::isfinite(curve.y[j * dims + d])) {
+                        area += std::fabs((px(previous) - average_x) * (py(j, d) - py(previous, d))
+                                          - (px(previous) - px(j)) * (average[d] - py(previous, d)));
+                    }
+                }
+                if (area > best_area) {
+                    best_area = area;
+                    best = j;
+                }
+            }
+            kept.push_back(best);
+            previous = best;
+        }
+        kept.push_back(last);
+    }
+    METRICS_ADD("numerics.sampling.decimated_points", curve.size() - kept.size());
+    return select(curve, kept);
+}
+
+sampled_curve min_max_decimate(const sampled_curve &curve, const std::size_t buckets) {
+    check_curve(curve);
+    const int dims = curve.dims;
+    if (buckets == 0 || curve.size() <= 2 * dims * buckets + 2) {
+        return curve;
+    }
+
+    const std::vector<std::pair<std::size_t, std::size_t> > runs = defined_runs(curve);
+    const std::vector<std::size_t> budgets = run_budgets(runs, curve.size(), buckets);
+    std::vector<std::size_t> kept, in_bucket;
+    for (std::size_t r = 0; r < runs.size(); r++) {
+        const std::size_t first = runs[r].first, last = runs[r].second - 1, length = last - first + 1;
+        const std::size_t m = budgets[r];
+        if (length <= 2 * dims * m + 2) {
+            for (std::size_t i = first; i <= last; i++) {
+                kept.push_back(i);
+            }
+            continue;
+        }
+        kept.push_back(first);
+        for (std::size_t k = 0; k < m; k++) {
+            const std::size_t begin = first + 1 + k * (length - 2) / m;
+            const std::size_t end = first + 1 + (k + 1) * (length - 2) / m;
+            in_bucket.clear();
+            for (int d = 0; d < dims; d++) {
+                std::size_t low = end, high = end;
+                for (std::size_t j = begin; j < end; j++) {
+                    const double v = curve.y[j * dims + d];
+                    if (!std::isfinite(v)) {
+                        continue;
+                    }
+                    if (low == end || v < curve.y[low * dims + d]) {
+                        low = j;
+                    }
+                    if (high == end || v > curve.y[high * dims + d]) {
+                        high = j;
+                    }
+                }
+                if (low != end) {
+                    in_bucket.push_back(low);
+                    in_bucket.push_back(high);
+                }
+            }
+            // точки корзины в порядке x, без повторов
+            std::sort(in_bucket.begin(), in_bucket.end());
+            in_bucket.erase(std::unique(in_bucket.begin(), in_bucket.end()), in_bucket.end());
+            kept.insert(kept.end(), in_bucket.begin(), in_bucket.end());
+        }
+        kept.push_back(last);
+    }
+    METRICS_ADD("numerics.sampling.decimated_points", curve.size() - kept.size());
+    return select(curve, kept);
+}
+
+} // namespace numerics
@@ -0,0 +1,100 @@
+#ifndef NUMERICS_SAMPLING_H
+#define NUMERICS_SAMPLING_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Несколько кривых над общей осью x: y[i * dims + d] - кривая d в точке x[i].
+ *
+ * NaN в y - кривая в этой точке не определена или разорвана (полюс):
+ * плоттеры рисуют линию только между соседними определенными точками.
+*/
+struct sampled_curve {
+    int dims;
+    std::vector<double> x;
+    std::vector<double> y;
+
+    std::size_t size() const {
+        return x.size();
+    }
+};
+
+/**
+ * @brief Значения всех кривых в точке x: y[0..dims-1].
+*/
+typedef std::function<void(double x, double *y)> curve_function;
+
+/**
+ * @brief Видимый диапазон значений одной кривой на графике.
+ *
+ * Значения за его пределами прижимаются к границам при оценке погрешности:
+ * у полюса tg x важно только то, что кривая уходит за край графика.
+ * lo == hi - диапазон по начальной сетке.
+*/
+struct view_range {
+    double lo;
+    double hi;
+};
+
+/**
+ * @brief Настройки адаптивной выборки.
+ *
+ * tolerance - допустимое отклонение ломаной от кривой в долях высоты графика
+ * (1e-3 - около пикселя при высоте 1000); initial_intervals - начальная
+ * равномерная сетка (должна хотя бы грубо разрешать самые быстрые колебания);
+ * max_depth - сколько раз можно делить начальный интервал пополам.
+*/
+struct sampling_settings {
+    double tolerance;
+    int initial_intervals;
+    int max_depth;
+};
+
+const sampling_settings default_sampling_settings = {1e-3, 64, 12};
+
+/**
+ * @brief Адаптивная выборка кривых для графика на [a,b].
+ *
+ * Интервал делится пополам, пока значение в середине отклоняется от хорды
+ * больше чем на tolerance высоты графика (по любой из кривых) или пока
+ * на нем начинается/кончается область определения кривой. Точки сгущаются
+ * там, где кривая изгибается или колеблется, а на пологих участках их мало:
+ * число точек определяется видом кривой, а не длиной отрезка.
+ *
+ * На полюсе (на последнем уровне деления значения по разные стороны края графика,
+ * а середина вне их диапазона) вставляется точка с NaN - разрыв линии.
+ *
+ * @param views видимые диапазоны кривых; пусто - по начальной сетке для всех.
+*/
+sampled_curve adaptive_sample(const curve_function &f, int dims, double a, double b,
+                              const std::vector<view_range> &views = std::vector<view_range>(),
+                              const sampling_settings &settings = default_sampling_settings);
+
+/**
+ * @brief Прореживание методом Largest-Triangle-Three-Buckets до target точек.
+ *
+ * Точки делятся на корзины, из каждой берется точка, образующая наибольший
+ * треугольник с выбранной точкой предыдущей корзины и средним следующей -
+ * сохраняет форму кривой. Первая и последняя точки, а также границы участков
+ * с NaN сохраняются, поэтому разрывы не пропадают, - если target хватает на две
+ * точки на участок. Иначе точки снимаются сначала с самых длинных участков, затем
+ * от участков остаются только первые точки: результат никогда не длиннее target.
+*/
+sampled_curve lttb_decimate(const sampled_curve &curve, std::size_t target);
+
+/**
+ * @brief Прореживание по минимумам и максимумам: в каждой из buckets корзин
+ * остаются точки минимума и максимума каждой кривой (не больше 2 * dims на корзину).
+ *
+ * Сохраняет огибающую быстрых колебаний точно - подходит для очень длинных рядов,
+ * которые рисуются уже, чем число точек.
+*/
+sampled_curve min_max_decimate(const sampled_curve &curve, std::size_t buckets);
+
+} // namespace numerics
+
+#endif
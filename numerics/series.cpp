@@ -0,0 +1,130 @@
+#include "series.h"
+
+#include <cmath>
+
+#include "compensated.h"
+#include "dispatch.h"
+
+namespace numerics {
+
+double maclaurin_sin(const double t, const int n_terms) {
+    double term = t;
+    double sum = term;
+    for (int n = 3; n <= n_terms; n += 2) {
+        term = -term * t * t / (n * (n - 1));
+        sum += term;
+    }
+    return sum;
+}
+
+double maclaurin_exp(const double t, const int n_terms) {
+    double term = 1.0;
+    double sum = term;
+    for (int n = 1; n <= n_terms; n++) {
+        term = term * t / n;
+        sum += term;
+    }
+    return sum;
+}
+
+double maclaurin_sin_compensated(const double t, const int n_terms) {
+    const double_double t2 = two_prod(t, t);
+    double_double term = make_double_double(t);
+    double_double sum = term;
+    for (int n = 3; n <= n_terms; n += 2) {
+        term = -(term * t2) / static_cast<double>(n * (n - 1));
+        sum = sum + term;
+    }
+    return to_double(sum);
+}
+
+double maclaurin_exp_compensated(const double t, const int n_terms) {
+    double_double term = make_double_double(1.0);
+    double_double sum = term;
+    for (int n = 1; n <= n_terms; n++) {
+        term = term * t / static_cast<double>(n);
+        sum = sum + term;
+    }
+    return to_double(sum);
+}
+
+NUMERICS_DISPATCH
+void maclaurin_sin(const double *t, double *out, const std::size_t count, const int n_terms) {
+    for (std::size_t i = 0; i < count; i++) {
+        const double x = t[i];
+        double term = x;
+        double sum = term;
+        for (int n = 3; n <= n_terms; n += 2) {
+            term = -term * x * x / (n * (n - 1));
+            sum += term;
+        }
+        out[i] = sum;
+    }
+}
+
+NUMERICS_DISPATCH
+void maclaurin_exp(const double *t, double *out, const std::size_t count, const int n_terms) {
+    for (std::size_t i = 0; i < count; i++) {
+        const double x = t[i];
+        double term = 1.0;
+        double sum = term;
+        for (int n = 1; n <= n_terms; n++) {
+            term = term * x / n;
+            sum += term;
+        }
+        out[i] = sum;
+    }
+}
+
+NUMERICS_DISPATCH
+void maclaurin_sin_compensated(const double *t, double *out, const std::size_t count, const int n_terms) {
+    for (std::size_t i = 0; i < count; i++) {
+        const double_double t2 = two_prod(t[i], t[i]);
+        double_double term = make_double_double(t[i]);
+        double_double sum = term;
+        for (int n = 3; n <= n_terms; n += 2) {
+            term = -(term * t2) / static_cast<double>(n * (n - 1));
+            sum = sum + term;
+        }
+        out[i] = to_double(sum);
+    }
+}
+
+NUMERICS_DISPATCH
+void maclaurin_exp_compensated(const double *t, double *out, const std::size_t count, const int n_terms) {
+    for (std::size_t i = 0; i < count; i++) {
+        double_double term = make_double_double(1.0);
+        double_double sum = term;
+        for (int n = 1; n <= n_terms; n++) {
+            term = term * t[i] / static_cast<double>(n);
+            sum = sum + term;
+        }
+        out[i] = to_double(sum);
+    }
+}
+
+double improved_sin(const double t) {
+    double reduced_t = fmod(t, 2 * M_PI);
+    if (reduced_t > M_PI) {
+        reduced_t -= 2 * M_PI;
+    } else if (reduced_t < -M_PI) {
+        reduced_t += 2 * M_PI;
+    }
+    return maclaurin_sin(reduced_t, 15);
+}
+
+double improved_exp(const double t) {
+    int k = 0;
+    double reduced_t = t;
+    while (reduced_t > 1.0) {
+        reduced_t /= 2.0;
+        k++;
+    }
+    double result = maclaurin_exp(reduced_t, 15);
+    for (int i = 0; i < k; i++) {
+        result *= result;
+    }
+    return result;
+}
+
+} // namespace numerics
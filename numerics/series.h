@@ -0,0 +1,72 @@
+#ifndef NUMERICS_SERIES_H
+#define NUMERICS_SERIES_H
+
+#include <cstddef>
+
+namespace numerics {
+
+/**
+ * @brief Частичная сумма ряда Маклорена для sin(t): t - t^3/3! + t^5/5! - ...
+ *
+ * @param t аргумент функции.
+ * @param n_terms старшая степень t в сумме.
+*/
+double maclaurin_sin(double t, int n_terms);
+
+/**
+ * @brief Частичная сумма ряда Маклорена для exp(t): 1 + t + t^2/2! + ... + t^n/n!
+ *
+ * @param t аргумент функции.
+ * @param n_terms старшая степень t в сумме.
+*/
+double maclaurin_exp(double t, int n_terms);
+
+/**
+ * @brief Пакетные версии: out[i] = maclaurin_*(t[i], n_terms) для i < count.
+ *
+ * Цикл по точкам векторизуется (каждая точка - своя дорожка вектора).
+*/
+void maclaurin_sin(const double *t, double *out, std::size_t count, int n_terms);
+
+void maclaurin_exp(const double *t, double *out, std::size_t count, int n_terms);
+
+/**
+ * @brief Те же частичные суммы, посчитанные в арифметике double-double.
+ *
+ * При больших t (например, sin(10.5)) слагаемые до 1e4 почти взаимно
+ * уничтожаются, и сумма в double теряет ~4 знака. Здесь слагаемые и сумма
+ * хранятся с ~32 знаками, результат верен до округления в double.
+*/
+double maclaurin_sin_compensated(double t, int n_terms);
+
+double maclaurin_exp_compensated(double t, int n_terms);
+
+/**
+ * @brief Пакетные версии сумм в double-double: out[i] = maclaurin_*_compensated(t[i], n_terms).
+ *
+ * Без ветвлений, поэтому цикл по точкам тоже векторизуется; результат
+ * побитно совпадает с поточечной версией.
+*/
+void maclaurin_sin_compensated(const double *t, double *out, std::size_t count, int n_terms);
+
+void maclaurin_exp_compensated(const double *t, double *out, std::size_t count, int n_terms);
+
+/**
+ * @brief Функция улучшенного алгоритма вычисления sin(t) для больших аргументов.
+ *
+ * Использует периодичность sin(t) = sin(t + 2pi k): приводит аргумент
+ * к [-pi, pi] и суммирует 15 членов ряда.
+*/
+double improved_sin(double t);
+
+/**
+ * @brief Функция улучшенного алгоритма вычисления exp(t) для больших аргументов.
+ *
+ * Использует exp(t) = exp(t/2)^2: делит аргумент пополам до t <= 1,
+ * суммирует 15 членов ряда и возводит результат в квадрат k раз.
+*/
+double improved_exp(double t);
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,275 @@
+#include "uncertainty.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "dispatch.h"
+#include "metrics.h"
+
+namespace numerics {
+
+namespace {
+
+const std::size_t block_samples = 4096;
+const std::size_t histogram_bins = 65536;
+
+/**
+ * @brief Philox4x32-10 (Salmon et al., 2011): 4 слова счетчика и 2 слова ключа -
+ * 4 случайных 32-битных слова. 10 раундов умножений с перестановкой.
+*/
+inline void philox4x32_10(std::uint32_t &c0, std::uint32_t &c1, std::uint32_t &c2, std::uint32_t &c3,
+                          std::uint32_t key0, std::uint32_t key1) {
+    for (int round = 0; round < 10; round++) {
+        if (round > 0) {
+            key0 += 0x9E3779B9u;
+            key1 += 0xBB67AE85u;
+        }
+        const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c0;
+        const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2;
+        const std::uint32_t x1 = c1, x3 = c3;
+        c0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1 ^ key0;
+        c1 = static_cast<std::uint32_t>(p1);
+        c2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3 ^ key1;
+        c3 = static_cast<std::uint32_t>(p0);
+    }
+}
+
+/**
+ * @brief Два равномерных числа в (0, 1] по 52 бита для наборов first .. first + count - 1
+ * входа j. Цикл без ветвлений - векторизуется в вариантах AVX2/AVX-512.
+*/
+NUMERICS_DISPATCH
+void uniform_pairs(const std::uint64_t seed, const std::uint32_t j, const std::size_t first, const std::size_t count,
+                   double *u1, double *u2) {
+    const std::uint32_t key0 = static_cast<std::uint32_t>(seed), key1 = static_cast<std::uint32_t>(seed >> 32);
+    const std::uint64_t one = 0x3FF0000000000000ull; // 1.0
+    for (std::size_t i = 0; i < count; i++) {
+        const std::uint64_t n = first + i;
+        std::uint32_t c0 = static_cast<std::uint32_t>(n), c1 = static_cast<std::uint32_t>(n >> 32), c2 = j, c3 = 0;
+        philox4x32_10(c0, c1, c2, c3, key0, key1);
+        // 52 старших бита пары слов - мантисса числа из [1, 2): без преобразования
+        // целого в double, которого нет в AVX2 и AVX-512F
+        const std::uint64_t a = one | (static_cast<std::uint64_t>(c0) << 32 | c1) >> 12;
+        const std::uint64_t b = one | (static_cast<std::uint64_t>(c2) << 32 | c3) >> 12;
+        double da, db;
+        std::memcpy(&da, &a, sizeof(double));
+        std::memcpy(&db, &b, sizeof(double));
+        u1[i] = 2.0 - da;
+        u2[i] = 2.0 - db;
+    }
+}
+
+/**
+ * @brief Среднее, сумма квадратов отклонений и границы блока значений.
+*/
+struct block_stats {
+    std::size_t count;
+    double mean;
+    double m2;
+    double min;
+    double max;
+};
+
+block_stats measure(const double *values, const std::size_t n) {
+    double sum = 0.0, low = values[0], high = values[0];
+    for (std::size_t i = 0; i < n; i++) {
+        sum += values[i];
+        low = std::min(low, values[i]);
+        high = std::max(high, values[i]);
+    }
+    const double mean = sum / n;
+    double m2 = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        m2 += (values[i] - mean) * (values[i] - mean);
+    }
+    block_stats s = {n, mean, m2, low, high};
+    return s;
+}
+
+/**
+ * @brief Слияние статистик двух частей выборки (Chan, Golub, LeVeque).
+*/
+block_stats merge(const block_stats &a, const block_stats &b) {
+    if (a.count == 0) {
+        return b;
+    }
+    const double n = static_cast<double>(a.count + b.count);
+    const double delta = b.mean - a.mean;
+    block_stats s = {
+        a.count + b.count, a.mean + delta * (b.count / n), a.m2 + b.m2 + delta * delta * (a.count * (b.count / n)),
+        std::min(a.min, b.min), std::max(a.max, b.max)
+    };
+    return s;
+}
+
+/**
+ * @brief Вызов body(block, inputs, values) для всех блоков в threads потоках.
+ *
+ * body получает буферы своего потока; исключение из любого потока останавливает
+ * раздачу блоков и пробрасывается в вызывающий поток.
+*/
+template <class Body>
+void for_each_block(const std::size_t blocks, const int threads, const std::size_t dims, Body body) {
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](const std::size_t thread) {
+        std::vector<double> inputs(dims * block_samples), values(block_samples);
+        try {
+            for (std::size_t b = next++; b < blocks; b = next++) {
+                body(thread, b, inputs.data(), values.data());
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = blocks;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, static_cast<std::size_t>(t));
+    }
+    worker(0);
+    for (std::thread &t: pool) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace
+
+double propagation_result::mean_error() const {
+    return samples > 0 ? std::sqrt(variance / samples) : 0.0;
+}
+
+void sample_inputs(const std::vector<uncertain_input> &inputs, const std::uint64_t seed, const std::size_t first,
+                   const std::size_t count, double *out) {
+    // Счетчик Philox - номер пары наборов: набор i берет половину i % 2 пары i / 2
+    const std::size_t pair_first = first / 2, pairs = (first + count + 1) / 2 - pair_first, shift = first % 2;
+    std::vector<double> u1(pairs), u2(pairs), z(2 * pairs);
+    for (std::size_t j = 0; j < inputs.size(); j++) {
+        const uncertain_input &in = inputs[j];
+        uniform_pairs(seed, static_cast<std::uint32_t>(j), pair_first, pairs, u1.data(), u2.data());
+        if (in.kind == normal_distribution) {
+            // Бокс-Мюллер: пара равномерных - пара независимых нормальных
+            for (std::size_t k = 0; k < pairs; k++) {
+                const double r = std::sqrt(-2.0 * std::log(u1[k])), angle = 2.0 * M_PI * u2[k];
+                z[2 * k] = r * std::cos(angle);
+                z[2 * k + 1] = r * std::sin(angle);
+            }
+        } else {
+            for (std::size_t k = 0; k < pairs; k++) {
+                z[2 * k] = 2.0 * u1[k] - 1.0;
+                z[2 * k + 1] = 2.0 * u2[k] - 1.0;
+            }
+        }
+        double *column = out + j * count;
+        for (std::size_t i = 0; i < count; i++) {
+            column[i] = in.center + in.spread * z[i + shift];
+        }
+    }
+}
+
+propagation_result propagate_uncertainty(const batch_model &model, const std::vector<uncertain_input> &inputs,
+                                         const propagation_settings &settings) {
+    if (inputs.empty() || settings.samples < 2) {
+        throw std::invalid_argument("нужны хотя бы один вход и два набора");
+    }
+    for (const double p: settings.probabilities) {
+        if (!(p >= 0.0 && p <= 1.0)) {
+            throw std::invalid_argument("уровень квантиля вне [0, 1]");
+        }
+    }
+    METRICS_TIMER("numerics.propagate_uncertainty");
+    METRICS_ADD("numerics.uncertainty.samples", settings.samples);
+
+    const std::size_t n = settings.samples, dims = inputs.size();
+    const std::size_t blocks = (n + block_samples - 1) / block_samples;
+    const unsigned hardware = std::thread::hardware_concurrency();
+    const int threads = static_cast<int>(std::min<std::size_t>(
+        blocks, settings.threads > 0 ? settings.threads : (hardware == 0 ? 1 : hardware)));
+
+    auto evaluate = [&](const std::size_t b, double *in, double *values) {
+        const std::size_t first = b * block_samples, count = std::min(block_samples, n - first);
+        sample_inputs(inputs, settings.seed, first, count, in);
+        model(in, values, count);
+        return count;
+    };
+
+    // Проход 1: статистики блоков, слияние по порядку блоков - не зависит от потоков
+    std::vector<block_stats> partial(blocks);
+    for_each_block(blocks, threads, dims, [&](std::size_t, const std::size_t b, double *in, double *values) {
+        const std::size_t count = evaluate(b, in, values);
+        partial[b] = measure(values, count);
+        if (!std::isfinite(partial[b].mean) || !std::isfinite(partial[b].m2)) {
+            throw std::runtime_error("модель вернула бесконечное значение или NaN");
+        }
+    });
+    block_stats total = {0, 0.0, 0.0, 0.0, 0.0};
+    for (const block_stats &s: partial) {
+        total = merge(total, s);
+    }
+
+    propagation_result result;
+    result.samples = n;
+    result.mean = total.mean;
+    result.variance = total.m2 / (n - 1);
+    result.min = total.min;
+    result.max = total.max;
+    result.probabilities = settings.probabilities;
+    if (settings.probabilities.empty()) {
+        return result;
+    }
+    if (!(total.max > total.min)) {
+        result.quantiles.assign(settings.probabilities.size(), total.min);
+        return result;
+    }
+
+    // Проход 2: те же наборы заново (счетчиковый генератор), гистограмма на [min, max]
+    const double scale = histogram_bins / (total.max - total.min);
+    std::vector<std::vector<std::uint64_t> > histograms(threads, std::vector<std::uint64_t>(histogram_bins));
+    for_each_block(blocks, threads, dims, [&](const std::size_t thread, const std::size_t b, double *in,
+                                              double *values) {
+        const std::size_t count = evaluate(b, in, values);
+        std::vector<std::uint64_t> &histogram = histograms[thread];
+        for (std::size_t i = 0; i < count; i++) {
+            const double position = (values[i] - total.min) * scale;
+            histogram[std::min(histogram_bins - 1, static_cast<std::size_t>(std::max(0.0, position)))]++;
+        }
+    });
+    std::vector<std::uint64_t> cumulative(histogram_bins);
+    std::uint64_t running = 0;
+    for (std::size_t k = 0; k < histogram_bins; k++) {
+        for (const std::vector<std::uint64_t> &histogram: histograms) {
+            running += histogram[k];
+        }
+        cumulative[k] = running;
+    }
+
+    // Квантиль - линейная интерполяция внутри ячейки, где накопленная доля достигает p
+    for (const double p: settings.probabilities) {
+        const double rank = p * n;
+        const std::size_t k = std::lower_bound(cumulative.begin(), cumulative.end(), rank) - cumulative.begin();
+        const std::size_t bin = std::min(k, histogram_bins - 1);
+        const double before = bin == 0 ? 0.0 : static_cast<double>(cumulative[bin - 1]);
+        const double inside = static_cast<double>(cumulative[bin]) - before;
+        const double fraction = inside > 0 ? (rank - before) / inside : 0.0;
+        result.quantiles.push_back(std::min(total.max, std::max(total.min, total.min + (bin + fraction) / scale)));
+    }
+    return result;
+}
+
+} // namespace numerics
@@ -0,0 +1,94 @@
+#ifndef NUMERICS_UNCERTAINTY_H
+#define NUMERICS_UNCERTAINTY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace numerics {
+
+/**
+ * @brief Распределение входной величины: нормальное (spread - стандартное отклонение)
+ * или равномерное на [center - spread, center + spread].
+*/
+enum distribution_kind {
+    normal_distribution,
+    uniform_distribution,
+};
+
+struct uncertain_input {
+    distribution_kind kind;
+    double center;
+    double spread;
+};
+
+/**
+ * @brief Пакетная модель: values[i] - результат для i-го набора входов, i < count.
+ *
+ * Входы лежат по столбцам: inputs[j * count + i] - вход j набора i, поэтому цикл
+ * по наборам в модели векторизуется. Модель вызывается из нескольких потоков
+ * одновременно и должна быть потокобезопасной; значения должны быть конечными.
+*/
+typedef std::function<void(const double *inputs, double *values, std::size_t count)> batch_model;
+
+/**
+ * @brief Настройки распространения погрешности.
+ *
+ * samples - число случайных наборов входов; seed - ключ генератора: при одном seed
+ * результат одинаков при любом числе потоков; threads - 0 - по числу ядер;
+ * probabilities - уровни квантилей результата.
+*/
+struct propagation_settings {
+    std::size_t samples;
+    std::uint64_t seed;
+    int threads;
+    std::vector<double> probabilities;
+};
+
+/**
+ * @brief Оценки распределения результата модели.
+ *
+ * quantiles[k] - квантиль уровня probabilities[k]; точность квантилей -
+ * (max - min) / 65536 (гистограмма второго прохода).
+*/
+struct propagation_result {
+    std::size_t samples;
+    double mean;
+    double variance;
+    double min;
+    double max;
+    std::vector<double> probabilities;
+    std::vector<double> quantiles;
+
+    /**
+     * @brief Стандартная ошибка оценки среднего sqrt(variance / samples).
+    */
+    double mean_error() const;
+};
+
+/**
+ * @brief Наборы входов с номерами first .. first + count - 1 (по столбцам, как в batch_model).
+ *
+ * Генератор счетчиковый (Philox4x32-10): значение входа j набора i зависит
+ * только от (seed, i, j), поэтому любой набор можно получить заново без хранения,
+ * а блоки наборов - генерировать в любом потоке в любом порядке.
+*/
+void sample_inputs(const std::vector<uncertain_input> &inputs, std::uint64_t seed, std::size_t first,
+                   std::size_t count, double *out);
+
+/**
+ * @brief Распространение погрешности входов через модель методом Монте-Карло.
+ *
+ * Наборы делятся на блоки по 4096, блоки раздаются потокам. Первый проход по наборам -
+ * среднее, дисперсия и границы: в блоке среднее и сумма квадратов отклонений от него
+ * считаются двумя циклами по значениям, блоки сливаются по порядку формулой Чана.
+ * Второй проход генерирует те же наборы заново и строит гистограмму для квантилей, так что
+ * память не зависит от числа наборов (1e8 наборов - несколько мегабайт).
+*/
+propagation_result propagate_uncertainty(const batch_model &model, const std::vector<uncertain_input> &inputs,
+                                         const propagation_settings &settings);
+
+} // namespace numerics
+
+#endif
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dispatch.h"
+#include "output_options.h"
+#include "solvers.h"
+
+/**
+ * @brief Задание конвейера: имя, каталог задания в репозитории и точка входа.
+*/
+struct job {
+    const char *name;
+    const char *task_dir;
+    int (*run)(const output_options &options);
+};
+
+const job jobs[] = {
+    {"task_1", "task_1", task_1::run},
+    {"task_2", "task_2", task_2::run},
+    {"1-8-19", "1-8-19", maclaurin::run},
+    {"6-9-29", "6-9-29", population::run},
+    {"4-12-7-б", "4-12-7-б", half_maximum::run},
+};
+
+/**
+ * @brief Строка файла конфигурации: задание и его настройки.
+ *
+ * plot - после расчета запустить C#-плоттер задания.
+ * options - какие файлы писать.
+*/
+struct job_request {
+    const job *target;
+    bool plot;
+    output_options options;
+};
+
+const job *find_job(const std::string &name) {
+    for (const job &j: jobs) {
+        if (name == j.name) {
+            return &j;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Чтение файла конфигурации конвейера.
+ *
+ * @param path путь к файлу.
+ * @param root корень репозитория.
+ *
+ * Формат: одно задание на строку, сначала имя задания, затем флаги
+ * plot, no-text, no-binary, no-cache. Пустые строки и строки с # пропускаются.
+ * Результаты пишутся сразу в data_generator/data задания - туда, откуда
+ * их читает плоттер, без промежуточного копирования.
+*/
+std::vector<job_request> read_config(const std::string &path, const std::string &root) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("не удалось открыть конфигурацию " + path);
+    }
+
+    std::vector<job_request> requests;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        const std::size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream words(line);
+        std::string name;
+        if (!(words >> name)) {
+            continue;
+        }
+
+        job_request request;
+        request.target = find_job(name);
+        if (request.target == nullptr) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": неизвестное задание " + name);
+        }
+        request.plot = false;
+        request.options = default_output_options();
+        request.options.dir = root + "/" + request.target->task_dir + "/data_generator/data";
+
+        std::string flag;
+        while (words >> flag) {
+            if (flag == "plot") {
+                request.plot = true;
+            } else if (flag == "no-text") {
+                request.options.text = false;
+            } else if (flag == "no-binary") {
+                request.options.binary = false;
+            } else if (flag == "no-cache") {
+                request.options.cache = false;
+            } else {
+                throw std::runtime_error(path + ":" + std::to_string(line_number) + ": неизвестный флаг " + flag);
+            }
+        }
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+/**
+ * @brief Единый запуск генераторов данных без пересборки и копирования файлов.
+ *
+ * Использование: pipeline [--root=DIR] [конфигурация]
+ * По умолчанию корень - каталог исходников, конфигурация - pipeline/pipeline.conf.
+*/
+int main(int argc, char **argv) {
+    std::string root = PIPELINE_SOURCE_ROOT;
+    std::string config;
+    const std::string root_flag = "--root=";
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, root_flag.size(), root_flag) == 0) {
+            root = arg.substr(root_flag.size());
+        } else {
+            config = arg;
+        }
+    }
+    if (config.empty()) {
+        config = root + "/pipeline/pipeline.conf";
+    }
+
+    std::vector<job_request> requests;
+    try {
+        requests = read_config(config, root);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Вычислительные ядра: " << numerics::active_isa() << "\n";
+
+    int failed = 0;
+    std::vector<double> seconds;
+    for (const job_request &request: requests) {
+        std::cout << "=== " << request.target->name << " ===\n";
+        // Задания меняют формат std::cout (fixed, setprecision) - не даем ему перейти к следующему
+        const std::ios_base::fmtflags cout_flags = std::cout.flags();
+        const std::streamsize cout_precision = std::cout.precision();
+        const auto start = std::chrono::steady_clock::now();
+        int code;
+        try {
+            std::filesystem::create_directories(request.options.dir);
+            code = request.target->run(request.options);
+        } catch (const std::exception &e) {
+            std::cerr << request.target->name << ": " << e.what() << "\n";
+            code = 1;
+        }
+        const auto finish = std::chrono::steady_clock::now();
+        seconds.push_back(std::chrono::duration<double>(finish - start).count());
+        std::cout.flags(cout_flags);
+        std::cout.precision(cout_precision);
+
+        if (code != 0) {
+            failed++;
+            continue;
+        }
+        if (request.plot) {
+            const std::string command = "cd \"" + root + "/" + request.target->task_dir + "/plotter\" && dotnet run";
+            if (std::system(command.c_str()) != 0) {
+                std::cerr << request.target->name << ": плоттер завершился с ошибкой\n";
+                failed++;
+            }
+        }
+    }
+
+    std::cout << "\n=== ВРЕМЯ РАСЧЕТА ===\n";
+    for (std::size_t i = 0; i < requests.size(); i++) {
+        std::cout << std::setw(12) << std::left << requests[i].target->name << " "
+                << std::fixed << std::setprecision(3) << seconds[i] << " с\n";
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "output_options.h"
+
+/**
+ * @brief Точки входа генераторов данных, собранных в библиотеку solvers.
+ *
+ * Каждая функция выполняет расчет своего задания и пишет результаты
+ * в options.dir. Возвращает код завершения, как main().
+*/
+namespace task_1 {
+int run(const output_options &options);
+}
+
+namespace task_2 {
+int run(const output_options &options);
+}
+
+namespace maclaurin {
+int run(const output_options &options);
+}
+
+namespace population {
+int run(const output_options &options);
+}
+
+namespace half_maximum {
+int run(const output_options &options);
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include "benchmarks.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "chebyshev.h"
+#include "dispatch.h"
+#include "fixed_point.h"
+#include "interpolation.h"
+#include "quadrature.h"
+#include "roots.h"
+#include "series.h"
+#include "uncertainty.h"
+
+#ifndef REGRESSION_BUILD_TYPE
+#define REGRESSION_BUILD_TYPE "unknown"
+#endif
+
+namespace regression {
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+volatile double sink;
+
+/**
+ * @brief Подынтегральная функция task_2: sin(100x) exp(-x^2) cos(2x).
+*/
+void task_2_integrand(const double *x, double *y, const std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        y[i] = std::sin(100.0 * x[i]) * std::exp(-x[i] * x[i]) * std::cos(2.0 * x[i]);
+    }
+}
+
+/**
+ * @brief F(x) = x^2 + tg^2 x - 1 из task_1.
+*/
+double task_1_residual(const double x) {
+    return x * x + std::tan(x) * std::tan(x) - 1.0;
+}
+
+/**
+ * @brief Точки t = a + (b - a) k / (count - 1).
+*/
+std::vector<double> grid(const double a, const double b, const std::size_t count) {
+    std::vector<double> t(count);
+    for (std::size_t k = 0; k < count; k++) {
+        t[k] = a + (b - a) * k / (count - 1);
+    }
+    return t;
+}
+
+/**
+ * @brief Калибровочный цикл: 2^20 шагов логистического отображения.
+ *
+ * Цепочка зависимых умножений не векторизуется и не зависит от кода numerics,
+ * поэтому ее время - единица стоимости: в отношении к нему сокращаются частота
+ * процессора и общая скорость машины.
+*/
+double calibration_loop() {
+    volatile double start = 0.3;
+    double x = start;
+    for (int i = 0; i < (1 << 20); i++) {
+        x = 3.9 * x * (1.0 - x);
+    }
+    return x;
+}
+
+double seconds_per_call(const std::function<double()> &f, const long calls) {
+    const bench_clock::time_point start = bench_clock::now();
+    double sum = 0.0;
+    for (long c = 0; c < calls; c++) {
+        sum += f();
+    }
+    const bench_clock::time_point finish = bench_clock::now();
+    sink = sum;
+    return std::chrono::duration<double>(finish - start).count() / calls;
+}
+
+/**
+ * @brief Число вызовов, которые длятся не меньше min_seconds; заодно прогрев.
+*/
+long calls_for(const std::function<double()> &f, const double min_seconds) {
+    long calls = 1;
+    while (seconds_per_call(f, calls) * calls < min_seconds) {
+        calls *= 2;
+    }
+    return calls;
+}
+
+std::vector<benchmark> make_benchmarks() {
+    std::vector<benchmark> list;
+
+    list.push_back({"simpson_method", "task_2", "узлов", 100001.0, []() {
+        return numerics::simpson_method(task_2_integrand, 0.0, 3.0, 100000);
+    }});
+
+    list.push_back({"chebyshev_roots", "task_1", "поисков", 1.0, []() {
+        double sum = 0.0;
+        for (const double root: numerics::chebyshev_roots(task_1_residual, -2.0, 2.0)) {
+            sum += root;
+        }
+        return sum;
+    }});
+
+    // maclaurin_sum из 1-8-19: суммы в double-double с найденными n на [10, 11]
+    const std::vector<double> t_sum = grid(10.0, 11.0, 100);
+    list.push_back({"maclaurin_sum", "1-8-19", "сумм", 2.0 * t_sum.size(), [t_sum]() {
+        double sum = 0.0;
+        for (const double t: t_sum) {
+            sum += numerics::maclaurin_sin_compensated(t, 31) + numerics::maclaurin_exp_compensated(t, 32);
+        }
+        return sum;
+    }});
+
+    // Пакетная сумма - модель распространения погрешности в 1-8-19
+    std::shared_ptr<std::vector<double> > t_batch = std::make_shared<std::vector<double> >(grid(10.0, 11.0, 4096));
+    std::shared_ptr<std::vector<double> > u_batch = std::make_shared<std::vector<double> >(4096);
+    list.push_back({"maclaurin_batch", "1-8-19", "сумм", 4096.0, [t_batch, u_batch]() {
+        numerics::maclaurin_exp_compensated(t_batch->data(), u_batch->data(), t_batch->size(), 32);
+        return (*u_batch)[0] + u_batch->back();
+    }});
+
+    list.push_back({"propagate_uncertainty", "1-8-19", "наборов", 65536.0, []() {
+        const numerics::batch_model model = [](const double *t, double *u, const std::size_t count) {
+            numerics::maclaurin_sin_compensated(t, u, count, 3);
+        };
+        const numerics::propagation_settings settings = {65536, 2024, 1, {0.025, 0.5, 0.975}};
+        const numerics::propagation_result r = numerics::propagate_uncertainty(
+            model, {{numerics::normal_distribution, 0.5, 1e-3}}, settings);
+        return r.mean + r.quantiles[1];
+    }});
+
+    // Перепись США 1910-2000 из 6-9-29, прогноз по всему отрезку до 2010 года
+    const std::vector<double> years = grid(1910.0, 2000.0, 10);
+    const std::vector<double> population = {
+        92228496, 106021537, 123202624, 132164569, 151325798,
+        179323175, 203211926, 226545805, 248709873, 281421906
+    };
+    const std::vector<std::vector<double> > diff = numerics::divided_differences(years, population);
+    std::shared_ptr<std::vector<double> > points = std::make_shared<std::vector<double> >(grid(1910.0, 2010.0, 10001));
+    std::shared_ptr<std::vector<double> > values = std::make_shared<std::vector<double> >(points->size());
+    list.push_back({"newton_interpolation", "6-9-29", "точек", 10001.0, [years, diff, points, values]() {
+        numerics::newton_interpolation(points->data(), values->data(), points->size(), years, diff);
+        return (*values)[0] + values->back();
+    }});
+
+    // 4-12-7-б: обе ветви x exp(-x^2) = f_max / 2 без ускорения, Стеффенсеном и Андерсоном
+    list.push_back({"fixed_point", "4-12-7-б", "решений", 6.0, []() {
+        const double x_max = 1.0 / std::sqrt(2.0), t = 0.5 * x_max * std::exp(-0.5);
+        const numerics::fixed_point_acceleration methods[] = {
+            numerics::acceleration_none, numerics::acceleration_steffensen, numerics::acceleration_anderson
+        };
+        double sum = 0.0;
+        for (const numerics::fixed_point_acceleration method: methods) {
+            numerics::fixed_point_settings settings = numerics::fixed_point_defaults(1e-12);
+            settings.acceleration = method;
+            settings.history = 2;
+            sum += numerics::fixed_point([t](const double x) { return t * std::exp(x * x); }, x_max - 0.2, settings).x;
+            sum += numerics::fixed_point([t](const double x) { return std::sqrt(std::log(x / t)); }, x_max + 0.4,
+                                         settings).x;
+        }
+        return sum;
+    }});
+    return list;
+}
+
+} // namespace
+
+const std::vector<benchmark> &benchmarks() {
+    static const std::vector<benchmark> list = make_benchmarks();
+    return list;
+}
+
+const benchmark *find_benchmark(const std::string &name) {
+    for (const benchmark &b: benchmarks()) {
+        if (name == b.name) {
+            return &b;
+        }
+    }
+    return nullptr;
+}
+
+measurement measure(const benchmark &b, const measurement_settings &settings) {
+    const std::function<double()> calibration = calibration_loop;
+    const long calibration_calls = calls_for(calibration, settings.min_seconds / 2);
+    const long calls = calls_for(b.run, settings.min_seconds);
+
+    // Калибровка в каждом повторе: замедление машины на время повтора сокращается в отношении
+    std::vector<double> costs, seconds;
+    for (int r = 0; r < settings.repeats; r++) {
+        const double unit = seconds_per_call(calibration, calibration_calls);
+        const double t = seconds_per_call(b.run, calls);
+        costs.push_back(t / unit);
+        seconds.push_back(t);
+    }
+    measurement m = {median_interval(costs), median_interval(seconds).median, calls};
+    return m;
+}
+
+std::string configuration() {
+    std::string c = numerics::active_isa();
+    c += " ";
+    c += REGRESSION_BUILD_TYPE;
+#ifdef METRICS_ENABLED
+    c += " metrics";
+#endif
+    return c;
+}
+
+const baseline_entry *baseline::find(const std::string &name) const {
+    for (const baseline_entry &e: entries) {
+        if (e.name == name) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+baseline read_baseline(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("не удалось открыть базовую линию " + path);
+    }
+    baseline b;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        const std::size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        std::string name;
+        if (!(words >> name)) {
+            continue;
+        }
+        if (name == "configuration") {
+            std::string word;
+            while (words >> word) {
+                b.configuration += (b.configuration.empty() ? "" : " ") + word;
+            }
+            continue;
+        }
+        baseline_entry e;
+        e.name = name;
+        if (!(words >> e.cost.median >> e.cost.low >> e.cost.high)) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": ожидались медиана и границы");
+        }
+        b.entries.push_back(e);
+    }
+    return b;
+}
+
+void write_baseline(const std::string &path, const baseline &b) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("не удалось записать базовую линию " + path);
+    }
+    out << "# Базовая линия regression_suite: нормированная стоимость вызова ядра\n"
+            "# (время вызова / время калибровочного цикла) - медиана и 95% интервал.\n"
+            "# Перезапись: cmake --build build --target regression_baseline\n";
+    out << "configuration " << b.configuration << "\n";
+    out << std::setprecision(6);
+    for (const baseline_entry &e: b.entries) {
+        out << e.name << " " << e.cost.median << " " << e.cost.low << " " << e.cost.high << "\n";
+    }
+    if (!out) {
+        throw std::runtime_error("ошибка записи " + path);
+    }
+}
+
+comparison compare(const interval_estimate &base, const interval_estimate &current, const double threshold) {
+    comparison c = {
+        base.median / current.median, base.low / current.high, base.high / current.low, false
+    };
+    c.regression = c.high < 1.0 - threshold;
+    return c;
+}
+
+} // namespace regression
@@ -0,0 +1,107 @@
+#ifndef REGRESSION_BENCHMARKS_H
+#define REGRESSION_BENCHMARKS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "statistics.h"
+
+namespace regression {
+
+/**
+ * @brief Бенчмарк вычислительного ядра задания.
+ *
+ * items - сколько элементов (узлов, точек, наборов) обрабатывает один вызов run,
+ * unit - их название для вывода пропускной способности. run возвращает контрольную
+ * сумму результата, чтобы компилятор не выбросил расчет.
+*/
+struct benchmark {
+    const char *name;
+    const char *task;
+    const char *unit;
+    double items;
+    std::function<double()> run;
+};
+
+/**
+ * @brief Все бенчмарки набора: по одному или два на каждый генератор данных.
+*/
+const std::vector<benchmark> &benchmarks();
+
+const benchmark *find_benchmark(const std::string &name);
+
+/**
+ * @brief repeats - число повторов; в каждом повторе ядро вызывается столько раз,
+ * чтобы замер длился не меньше min_seconds.
+*/
+struct measurement_settings {
+    int repeats;
+    double min_seconds;
+};
+
+const measurement_settings default_measurement_settings = {21, 0.02};
+
+/**
+ * @brief Результат замера.
+ *
+ * cost - нормированная стоимость вызова: время вызова, деленное на время
+ * калибровочного цикла в том же повторе (медиана и 95% интервал по повторам);
+ * seconds - медиана абсолютного времени вызова; calls - вызовов в повторе.
+*/
+struct measurement {
+    interval_estimate cost;
+    double seconds;
+    long calls;
+};
+
+measurement measure(const benchmark &b, const measurement_settings &settings);
+
+/**
+ * @brief Конфигурация сборки, для которой сравнимы замеры: вариант ядер
+ * (numerics::active_isa), тип сборки и инструментирование метриками.
+*/
+std::string configuration();
+
+struct baseline_entry {
+    std::string name;
+    interval_estimate cost;
+};
+
+/**
+ * @brief Базовая линия - файл с нормированными стоимостями бенчмарков.
+ *
+ * Формат: строка "configuration <конфигурация>", затем по строке на бенчмарк:
+ * имя, медиана, нижняя и верхняя граница интервала. Строки с # - комментарии.
+*/
+struct baseline {
+    std::string configuration;
+    std::vector<baseline_entry> entries;
+
+    const baseline_entry *find(const std::string &name) const;
+};
+
+baseline read_baseline(const std::string &path);
+
+void write_baseline(const std::string &path, const baseline &b);
+
+/**
+ * @brief Сравнение с базовой линией: отношение пропускных способностей
+ * baseline / current (меньше 1 - замедление) и его границы.
+ *
+ * Границы консервативны: low = baseline.low / current.high, high = baseline.high / current.low.
+ * Регрессия - когда даже верхняя граница меньше 1 - threshold, т.е. замедление
+ * больше порога заметно с учетом разброса обоих замеров.
+*/
+struct comparison {
+    double ratio;
+    double low;
+    double high;
+    bool regression;
+};
+
+comparison compare(const interval_estimate &base, const interval_estimate &current, double threshold);
+
+} // namespace regression
+
+#endif
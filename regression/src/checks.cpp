@@ -0,0 +1,133 @@
+#include "checks.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "autodiff.h"
+#include "continuation.h"
+#include "sampling.h"
+
+namespace regression {
+
+namespace {
+
+/**
+ * @brief Допуск на относительное расхождение производной с формулой.
+*/
+const double tolerance = 1e-12;
+
+/**
+ * @brief Сравнение производной с формулой: печатает строку только при несовпадении.
+*/
+int compare(const char *name, const double x, const double lambda, const double automatic, const double formula) {
+    const double error = std::fabs(automatic - formula) / std::max(1.0, std::fabs(formula));
+    if (error <= tolerance) {
+        return 0;
+    }
+    std::cout << "FAIL " << name << "(x = " << x << ", lambda = " << lambda << ") = " << automatic
+            << ", формула " << formula << "\n";
+    return 1;
+}
+
+/**
+ * @brief Кривая sin(0.01 x) в точках x = 0..size-1, где начиная с from каждая
+ * period-я точка - NaN.
+*/
+numerics::sampled_curve broken_curve(const std::size_t size, const std::size_t period, const std::size_t from) {
+    numerics::sampled_curve curve = {1, {}, {}};
+    for (std::size_t i = 0; i < size; i++) {
+        curve.x.push_back(static_cast<double>(i));
+        curve.y.push_back(i >= from && (i - from) % period == period - 1 ? NAN : std::sin(0.01 * i));
+    }
+    return curve;
+}
+
+std::size_t count_nan(const numerics::sampled_curve &curve) {
+    std::size_t count = 0;
+    for (const double y: curve.y) {
+        count += std::isnan(y) ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace
+
+int check_task_1_derivatives() {
+    std::cout << "\n=== ПРОИЗВОДНЫЕ: task_1 ===\n" << std::setprecision(17);
+    typedef numerics::dual<2> var;
+    // Меняются и r, и k, чтобы H_lambda зависела от обоих
+    const parameter_path path = {{4.0, 1.0}, {1.0, 2.0}};
+    const double dr = path.to.r - path.from.r;
+    const double dk = path.to.k - path.from.k;
+    int checked = 0, failures = 0;
+    for (int i = 0; i <= 40; i++) {
+        const double x = -1.2 + 2.4 * i / 40;
+        for (int j = 0; j <= 10; j++) {
+            const double lambda = j / 10.0;
+            const system_params p = path.at(lambda);
+            if (std::fabs(std::cos(p.k * x)) < 0.1) {
+                continue;
+            }
+
+            // H = x^2 + tg^2(k x) - r^2: H_x = 2x + 2k t (1 + t^2), H_lambda = 2x t (1 + t^2) dk - 2r dr
+            const double t = std::tan(p.k * x);
+            double H, H_x, H_lambda;
+            homotopy_residual(path, x, lambda, H, H_x, H_lambda);
+            failures += compare("H_x", x, lambda, H_x, 2 * x + 2 * p.k * t * (1 + t * t));
+            failures += compare("H_lambda", x, lambda, H_lambda, 2 * x * t * (1 + t * t) * dk - 2 * p.r * dr);
+
+            // Система x^2 + y^2 = r^2, y = tg(k x): J = ((2x, 2y), (-k (1 + tg^2(k x)), 1))
+            const std::array<double, 2> point = {x, t};
+            std::array<double, 2> values;
+            std::array<std::array<double, 2>, 2> J;
+            numerics::jacobian<2, 2>([&p](const std::array<var, 2> &v) {
+                const std::array<var, 2> f = {v[0] * v[0] + v[1] * v[1] - p.r * p.r, v[1] - tan(p.k * v[0])};
+                return f;
+            }, point, values, J);
+            const double formula[2][2] = {{2 * x, 2 * t}, {-p.k * (1 + t * t), 1.0}};
+            for (int a = 0; a < 2; a++) {
+                for (int b = 0; b < 2; b++) {
+                    failures += compare("J", x, lambda, J[a][b], formula[a][b]);
+                }
+            }
+            checked += 6;
+        }
+    }
+    std::cout << (failures == 0 ? "OK   " : "FAIL ") << checked << " производных, допуск " << std::setprecision(3) << tolerance << "\n";
+    return failures;
+}
+
+int check_task_2_decimation() {
+    std::cout << "\n=== ПРОРЕЖИВАНИЕ: task_2 ===\n";
+    struct decimation_case {
+        std::size_t size;
+        std::size_t period;
+        std::size_t from;
+        std::size_t target;
+        bool keeps_breaks;
+    };
+    // Разрывов мало; длинный гладкий участок и за ним много коротких (точки снимаются
+    // с длинного); участков больше target - от кривой остаются первые точки участков
+    const decimation_case cases[] = {
+        {100000, 5000, 0, 2000, true},
+        {101200, 3, 100000, 2000, true},
+        {20000, 3, 0, 2000, false},
+        {20000, 2, 0, 2000, false},
+    };
+    int failures = 0;
+    for (const decimation_case &c: cases) {
+        const numerics::sampled_curve curve = broken_curve(c.size, c.period, c.from);
+        const numerics::sampled_curve plot = numerics::lttb_decimate(curve, c.target);
+        const bool ok = plot.size() <= c.target && (!c.keeps_breaks || count_nan(plot) == count_nan(curve));
+        std::cout << (ok ? "OK   " : "FAIL ") << c.size << " точек, NaN каждая " << c.period << "-я с " << c.from << ": "
+                << plot.size() << " из " << c.target << ", разрывов " << count_nan(plot) << " из "
+                << count_nan(curve) << "\n";
+        failures += ok ? 0 : 1;
+    }
+    return failures;
+}
+
+} // namespace regression
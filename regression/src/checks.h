@@ -0,0 +1,24 @@
+#ifndef REGRESSION_CHECKS_H
+#define REGRESSION_CHECKS_H
+
+namespace regression {
+
+/**
+ * @brief Проверка производных task_1, найденных автоматическим дифференцированием
+ * (numerics::jacobian), по формулам, выписанным вручную.
+ *
+ * @return число несовпадений.
+*/
+int check_task_1_derivatives();
+
+/**
+ * @brief Проверка прореживания графика task_2 (numerics::lttb_decimate) на кривых
+ * с разрывами: не больше target точек, разрывы сохраняются, пока их хватает.
+ *
+ * @return число несовпадений.
+*/
+int check_task_2_decimation();
+
+} // namespace regression
+
+#endif
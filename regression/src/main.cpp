@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "benchmarks.h"
+#include "dispatch.h"
+#include "references.h"
+
+/**
+ * @brief Код завершения, по которому CTest помечает тест пропущенным (SKIP_RETURN_CODE).
+*/
+const int skip_code = 77;
+
+/**
+ * @brief Замер бенчмарка и сравнение с базовой линией.
+ *
+ * Если базовая линия снята в другой конфигурации (другой вариант ядер, тип сборки,
+ * метрики), замеры несравнимы - тест пропускается.
+*/
+int bench(const std::string &name, const std::string &baseline_path, const double threshold,
+          const regression::measurement_settings &settings) {
+    const regression::benchmark *b = regression::find_benchmark(name);
+    if (b == nullptr) {
+        std::cerr << "неизвестный бенчмарк " << name << "\n";
+        return 1;
+    }
+    const regression::baseline base = regression::read_baseline(baseline_path);
+    if (base.configuration != regression::configuration()) {
+        std::cout << "базовая линия снята в конфигурации \"" << base.configuration << "\", текущая - \""
+                << regression::configuration() << "\": сравнение пропущено\n";
+        return skip_code;
+    }
+    const regression::baseline_entry *entry = base.find(name);
+    if (entry == nullptr) {
+        std::cerr << "нет бенчмарка " << name << " в " << baseline_path
+                << " - перезапишите базовую линию (цель regression_baseline)\n";
+        return 1;
+    }
+
+    const regression::measurement m = regression::measure(*b, settings);
+    const regression::comparison c = regression::compare(entry->cost, m.cost, threshold);
+    std::cout << std::setprecision(4)
+            << name << " (" << b->task << "), " << settings.repeats << " повторов по " << m.calls << " вызовов\n"
+            << "время вызова:           " << m.seconds * 1e6 << " мкс, "
+            << b->items / m.seconds << " " << b->unit << "/с\n"
+            << "стоимость (медиана):    " << m.cost.median << " [" << m.cost.low << ", " << m.cost.high << "]\n"
+            << "базовая линия:          " << entry->cost.median << " [" << entry->cost.low << ", "
+            << entry->cost.high << "]\n"
+            << "пропускная способность: " << c.ratio << " от базовой [" << c.low << ", " << c.high << "], порог "
+            << 1.0 - threshold << "\n"
+            << (c.regression ? "РЕГРЕССИЯ" : "OK") << "\n";
+    return c.regression ? 1 : 0;
+}
+
+/**
+ * @brief Замер всех бенчмарков и запись базовой линии.
+*/
+void record(const std::string &baseline_path, const regression::measurement_settings &settings) {
+    regression::baseline base;
+    base.configuration = regression::configuration();
+    for (const regression::benchmark &b: regression::benchmarks()) {
+        const regression::measurement m = regression::measure(b, settings);
+        std::cout << std::setprecision(4) << std::setw(24) << std::left << b.name << " " << m.cost.median
+                << " [" << m.cost.low << ", " << m.cost.high << "], " << m.seconds * 1e6 << " мкс\n";
+        regression::baseline_entry e = {b.name, m.cost};
+        base.entries.push_back(e);
+    }
+    regression::write_baseline(baseline_path, base);
+    std::cout << "базовая линия (" << base.configuration << ") записана в " << baseline_path << "\n";
+}
+
+/**
+ * @brief Набор регрессионных тестов генераторов данных.
+ *
+ * Использование: regression_suite [--references=PATH] [--baseline=PATH] [--threshold=X]
+ *                [--repeats=N] [--min-time=S] [--work-dir=DIR] check TASK | bench NAME | record | list
+ * check - расчет задания без кэша и сравнение выходных таблиц с эталонами,
+ * bench - замер ядра и сравнение с базовой линией (код 1 при падении пропускной
+ * способности больше чем на threshold, 77 - конфигурация не совпадает с базовой),
+ * record - перезапись базовой линии, list - задания и бенчмарки.
+*/
+int main(int argc, char **argv) {
+    std::string references_path = REGRESSION_SOURCE_DIR "/references.txt";
+    std::string baseline_path = REGRESSION_SOURCE_DIR "/baseline.txt";
+    std::string work_dir = "regression_work";
+    double threshold = 0.25;
+    regression::measurement_settings settings = regression::default_measurement_settings;
+    std::string command, target;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        try {
+            if (name == "--references") {
+                references_path = value;
+            } else if (name == "--baseline") {
+                baseline_path = value;
+            } else if (name == "--work-dir") {
+                work_dir = value;
+            } else if (name == "--threshold") {
+                threshold = std::stod(value);
+                if (!(threshold > 0.0 && threshold < 1.0)) {
+                    throw std::invalid_argument(arg);
+                }
+            } else if (name == "--repeats") {
+                settings.repeats = std::max(1, std::stoi(value));
+            } else if (name == "--min-time") {
+                settings.min_seconds = std::stod(value);
+            } else if (command.empty() && (arg == "check" || arg == "bench" || arg == "record" || arg == "list")) {
+                command = arg;
+            } else if (target.empty() && (command == "check" || command == "bench")) {
+                target = arg;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception &) {
+            std::cerr << "неизвестный или некорректный аргумент " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        std::cout << "Вычислительные ядра: " << numerics::active_isa() << "\n";
+        if (command == "check" && !target.empty()) {
+            const int failures = regression::check_task(target, regression::read_references(references_path),
+                                                        work_dir + "/" + target);
+            return failures == 0 ? 0 : 1;
+        } else if (command == "bench" && !target.empty()) {
+            return bench(target, baseline_path, threshold, settings);
+        } else if (command == "record") {
+            record(baseline_path, settings);
+        } else if (command == "list") {
+            for (const std::string &task: regression::task_names()) {
+                std::cout << "check " << task << "\n";
+            }
+            for (const regression::benchmark &b: regression::benchmarks()) {
+                std::cout << "bench " << b.name << " (" << b.task << ")\n";
+            }
+        } else {
+            std::cerr << "использование: regression_suite [--references=PATH] [--baseline=PATH] [--threshold=X] "
+                    "[--repeats=N] [--min-time=S] [--work-dir=DIR] check TASK | bench NAME | record | list\n";
+            return 1;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "references.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "checks.h"
+#include "columnar_writer.h"
+#include "output_options.h"
+#include "solvers.h"
+
+namespace regression {
+
+namespace {
+
+/**
+ * @brief Генератор задания и дополнительная проверка его ядер (nullptr - только эталоны).
+*/
+struct job {
+    const char *name;
+    int (*run)(const output_options &options);
+    int (*check)();
+};
+
+const job jobs[] = {
+    {"task_1", task_1::run, check_task_1_derivatives},
+    {"task_2", task_2::run, check_task_2_decimation},
+    {"1-8-19", maclaurin::run, nullptr},
+    {"6-9-29", population::run, nullptr},
+    {"4-12-7-б", half_maximum::run, nullptr},
+};
+
+/**
+ * @brief Значение величины quantity из таблицы: атрибут или колонка[строка].
+*/
+bool lookup(const columnar::table &t, const std::string &quantity, double &value) {
+    const std::size_t bracket = quantity.find('[');
+    if (bracket == std::string::npos) {
+        for (std::size_t a = 0; a < t.attribute_keys.size(); a++) {
+            if (t.attribute_keys[a] == quantity) {
+                value = t.attribute_values[a];
+                return true;
+            }
+        }
+        return false;
+    }
+    const std::string column = quantity.substr(0, bracket);
+    const std::size_t row = std::stoul(quantity.substr(bracket + 1));
+    for (std::size_t c = 0; c < t.columns.size(); c++) {
+        if (t.columns[c] == column && row < t.data[c].size()) {
+            value = t.data[c][row];
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<reference> read_references(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("не удалось открыть эталоны " + path);
+    }
+    std::vector<reference> references;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        const std::size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        reference r;
+        if (!(words >> r.task)) {
+            continue;
+        }
+        if (!(words >> r.file >> r.quantity >> r.value >> r.tolerance)) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number)
+                                     + ": ожидались файл, величина, значение и допуск");
+        }
+        r.line = line_number;
+        references.push_back(r);
+    }
+    return references;
+}
+
+std::vector<std::string> task_names() {
+    std::vector<std::string> names;
+    for (const job &j: jobs) {
+        names.push_back(j.name);
+    }
+    return names;
+}
+
+int check_task(const std::string &task, const std::vector<reference> &references, const std::string &work_dir) {
+    const job *target = nullptr;
+    for (const job &j: jobs) {
+        if (task == j.name) {
+            target = &j;
+        }
+    }
+    if (target == nullptr) {
+        throw std::runtime_error("неизвестное задание " + task);
+    }
+
+    output_options options = default_output_options();
+    options.cache = false;
+    options.dir = work_dir;
+    std::filesystem::create_directories(work_dir);
+    const std::ios_base::fmtflags cout_flags = std::cout.flags();
+    const std::streamsize cout_precision = std::cout.precision();
+    const int code = target->run(options);
+    std::cout.flags(cout_flags);
+    std::cout.precision(cout_precision);
+    if (code != 0) {
+        std::cout << task << ": генератор завершился с кодом " << code << "\n";
+        return 1;
+    }
+
+    std::cout << "\n=== СРАВНЕНИЕ С ЭТАЛОНАМИ: " << task << " ===\n" << std::setprecision(17);
+    std::map<std::string, columnar::table> tables;
+    int checked = 0, failures = 0;
+    for (const reference &r: references) {
+        if (r.task != task) {
+            continue;
+        }
+        checked++;
+        if (tables.find(r.file) == tables.end()) {
+            tables[r.file] = columnar::read(options.path(r.file));
+        }
+        double value = NAN;
+        const bool found = lookup(tables[r.file], r.quantity, value);
+        const bool ok = found && std::fabs(value - r.value) <= r.tolerance * std::max(1.0, std::fabs(r.value));
+        std::cout << (ok ? "OK   " : "FAIL ") << r.file << " " << r.quantity << " = ";
+        if (found) {
+            std::cout << value;
+        } else {
+            std::cout << "(нет в файле)";
+        }
+        std::cout << ", эталон " << r.value << " +- " << std::setprecision(3) << r.tolerance << std::setprecision(17);
+        if (!ok) {
+            std::cout << " (строка " << r.line << ")";
+            failures++;
+        }
+        std::cout << "\n";
+    }
+    if (checked == 0) {
+        std::cout << "нет эталонов для задания " << task << "\n";
+        return 1;
+    }
+    if (target->check != nullptr) {
+        failures += target->check();
+    }
+    return failures;
+}
+
+} // namespace regression
@@ -0,0 +1,47 @@
+#ifndef REGRESSION_REFERENCES_H
+#define REGRESSION_REFERENCES_H
+
+#include <string>
+#include <vector>
+
+namespace regression {
+
+/**
+ * @brief Эталонное значение из выходного файла генератора данных.
+ *
+ * quantity - имя атрибута таблицы file или "колонка[строка]"; значение принимается,
+ * если |x - value| <= tolerance * max(1, |value|); line - строка в файле эталонов.
+*/
+struct reference {
+    std::string task;
+    std::string file;
+    std::string quantity;
+    double value;
+    double tolerance;
+    int line;
+};
+
+/**
+ * @brief Чтение файла эталонов: по строке "задание файл величина значение допуск",
+ * строки с # - комментарии.
+*/
+std::vector<reference> read_references(const std::string &path);
+
+/**
+ * @brief Имена заданий, для которых есть генератор данных в библиотеке solvers.
+*/
+std::vector<std::string> task_names();
+
+/**
+ * @brief Проверка генератора данных task: расчет без кэша в каталог work_dir,
+ * сравнение бинарных таблиц с эталонами этого задания и, если есть,
+ * дополнительная проверка его ядер (производные task_1, прореживание графика task_2).
+ *
+ * @return число несовпадений (ненулевой код завершения генератора и отсутствие
+ * эталонов для задания тоже считаются несовпадением).
+*/
+int check_task(const std::string &task, const std::vector<reference> &references, const std::string &work_dir);
+
+} // namespace regression
+
+#endif
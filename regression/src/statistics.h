@@ -0,0 +1,55 @@
+#ifndef REGRESSION_STATISTICS_H
+#define REGRESSION_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace regression {
+
+/**
+ * @brief Медиана выборки и доверительный интервал для нее [low, high].
+*/
+struct interval_estimate {
+    double median;
+    double low;
+    double high;
+};
+
+/**
+ * @brief Медиана и непараметрический доверительный интервал уровня confidence.
+ *
+ * Интервал - порядковые статистики [x_(j), x_(n-j+1)]: число наблюдений ниже
+ * истинной медианы распределено по Bin(n, 1/2), j - наибольшее, при котором
+ * P(Bin(n, 1/2) < j) <= (1 - confidence) / 2. Не требует нормальности, поэтому
+ * годится для времен с тяжелым правым хвостом (прерывания, вытеснение потока).
+ * При малых n (для 95% - меньше 6) интервал - вся выборка.
+*/
+inline interval_estimate median_interval(std::vector<double> samples, const double confidence = 0.95) {
+    if (samples.empty()) {
+        throw std::invalid_argument("median_interval: пустая выборка");
+    }
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+    const double median = n % 2 == 1 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+
+    // P(Bin(n, 1/2) = k) через логарифм биномиального коэффициента
+    const double alpha = (1.0 - confidence) / 2.0;
+    double tail = 0.0;
+    std::size_t j = 0;
+    for (std::size_t k = 0; k < n / 2; k++) {
+        tail += std::exp(std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0) - n * std::log(2.0));
+        if (tail > alpha) {
+            break;
+        }
+        j = k + 1;
+    }
+    const std::size_t lower = j == 0 ? 0 : j - 1;
+    interval_estimate e = {median, samples[lower], samples[n - 1 - lower]};
+    return e;
+}
+
+} // namespace regression
+
+#endif
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client.h"
+#include "latency.h"
+#include "quadrature.h"
+#include "series.h"
+
+namespace job_server {
+
+typedef std::chrono::steady_clock client_clock;
+
+request make_request(const std::uint32_t id, const std::uint8_t kernel, const std::uint8_t op,
+                     const std::vector<std::int32_t> &ints, const std::vector<double> &doubles) {
+    request r = {id, kernel, op, ints, doubles};
+    return r;
+}
+
+bool close_to(const double a, const double b, const double tolerance) {
+    return std::fabs(a - b) <= tolerance * std::max(1.0, std::fabs(b));
+}
+
+/**
+ * @brief Проверка каждого ядра: ответ сервера сравнивается с тем же расчетом
+ * библиотекой numerics в этом процессе или с точным значением.
+ *
+ * @return число несовпадений.
+*/
+int check(const std::string &socket_path) {
+    client c(socket_path);
+    int failures = 0;
+    auto report = [&failures](const char *name, const bool ok, const response &r) {
+        std::cout << name << ": " << (ok ? "OK" : "ОШИБКА")
+                << "  (очередь " << r.queue_us << " мкс, расчет " << r.compute_us << " мкс)";
+        if (!r.message.empty()) {
+            std::cout << ": " << r.message;
+        }
+        std::cout << "\n";
+        failures += ok ? 0 : 1;
+    };
+
+    {
+        const std::vector<double> t = {0.1, 0.5, 1.0, 3.0, 10.5};
+        const response r = c.call(make_request(1, kernel_series, 0, {25}, t));
+        bool ok = r.status == status_ok && r.values.size() == t.size();
+        for (std::size_t i = 0; ok && i < t.size(); i++) {
+            ok = close_to(r.values[i], numerics::maclaurin_sin(t[i], 25), 1e-14);
+        }
+        report("ряд Маклорена sin, 25 членов", ok, r);
+    }
+    {
+        // sin(100x) exp(-x^2) cos(2x) = (sin(102x) + sin(98x)) exp(-x^2) / 2, sin u = cos(u - pi/2)
+        const std::vector<double> doubles = {0.0, 3.0, 0.5, 0, 1.0, 102.0, -M_PI / 2, 0.5, 0, 1.0, 98.0, -M_PI / 2};
+        const response r = c.call(make_request(2, kernel_integrate, method_simpson, {100000}, doubles));
+        const double local = numerics::simpson_method([](const double *x, double *y, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                y[i] = std::sin(100.0 * x[i]) * std::exp(-x[i] * x[i]) * std::cos(2.0 * x[i]);
+            }
+        }, 0.0, 3.0, 100000);
+        report("интеграл task_2, Симпсон", r.status == status_ok && r.values.size() == 1
+                                          && close_to(r.values[0], local, 1e-12), r);
+    }
+    {
+        // cos(3x) на [0, 3]: корни pi/6, pi/2, 5pi/6
+        const response r = c.call(make_request(3, kernel_roots, 0, {}, {0.0, 3.0, 1.0, 0, 0.0, 3.0, 0.0}));
+        const double exact[3] = {M_PI / 6, M_PI / 2, 5 * M_PI / 6};
+        bool ok = r.status == status_ok && r.values.size() == 3;
+        for (std::size_t i = 0; ok && i < 3; i++) {
+            ok = close_to(r.values[i], exact[i], 1e-13);
+        }
+        report("корни cos(3x) на [0, 3]", ok, r);
+    }
+    {
+        // y = x^3 по 4 узлам: полином Ньютона точен, сплайн - середина хорды
+        const std::vector<double> doubles = {0, 1, 2, 3, 0, 1, 8, 27, 1.5};
+        const response newton = c.call(make_request(4, kernel_interpolate, 0, {4}, doubles));
+        report("полином Ньютона", newton.status == status_ok && newton.values.size() == 1
+                                 && close_to(newton.values[0], 3.375, 1e-15), newton);
+        const response spline = c.call(make_request(5, kernel_interpolate, 1, {4}, doubles));
+        report("линейный сплайн", spline.status == status_ok && spline.values.size() == 1
+                                 && close_to(spline.values[0], 4.5, 1e-15), spline);
+    }
+    {
+        const response r = c.call(make_request(6, kernel_series, 0, {0}, {1.0}));
+        report("некорректный запрос отклоняется", r.status == status_bad_request && r.id == 6, r);
+    }
+    return failures;
+}
+
+/**
+ * @brief Нагрузочный тест: connections потоков, в каждом до window запросов
+ * kernel_series в полете; задержка - от отправки до получения ответа.
+*/
+void bench(const std::string &socket_path, const int connections, const int requests, const int points,
+           const int window) {
+    std::vector<latency_histogram> histograms(connections);
+    std::vector<std::string> errors(connections);
+    std::vector<std::thread> threads;
+    const client_clock::time_point start = client_clock::now();
+    for (int t = 0; t < connections; t++) {
+        threads.emplace_back([&, t]() {
+            try {
+                client c(socket_path);
+                std::mt19937_64 random(t);
+                std::uniform_real_distribution<double> uniform(-3.0, 3.0);
+                const int total = requests / connections;
+                std::vector<client_clock::time_point> sent(total);
+                std::vector<double> t_values(points);
+                int next = 0;
+                for (int done = 0; done < total; done++) {
+                    while (next < total && next - done < window) {
+                        for (double &value: t_values) {
+                            value = uniform(random);
+                        }
+                        sent[next] = client_clock::now();
+                        c.send(make_request(static_cast<std::uint32_t>(next), kernel_series, 0, {20}, t_values));
+                        next++;
+                    }
+                    const response r = c.receive();
+                    if (r.status != status_ok) {
+                        throw std::runtime_error("сервер вернул ошибку: " + r.message);
+                    }
+                    const auto rtt = client_clock::now() - sent[r.id];
+                    histograms[t].add(std::chrono::duration_cast<std::chrono::microseconds>(rtt).count());
+                }
+            } catch (const std::exception &e) {
+                errors[t] = e.what();
+            }
+        });
+    }
+    for (std::thread &t: threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(client_clock::now() - start).count();
+    for (const std::string &error: errors) {
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+    }
+
+    latency_histogram total;
+    for (const latency_histogram &h: histograms) {
+        total.merge(h);
+    }
+    std::cout << "Запросов: " << total.count() << " за " << std::fixed << std::setprecision(3) << seconds
+            << " с (" << std::setprecision(0) << total.count() / seconds << " в секунду)\n";
+    std::cout << "Задержка клиента, мкс: p50 " << total.percentile(0.5) << ", p90 " << total.percentile(0.9)
+            << ", p99 " << total.percentile(0.99) << ", max " << total.max() << "\n";
+}
+
+void stats(const std::string &socket_path) {
+    client c(socket_path);
+    const response r = c.call(make_request(0, kernel_stats, 0, {}, {}));
+    if (r.status != status_ok || r.values.size() != 8) {
+        throw std::runtime_error("некорректный ответ статистики");
+    }
+    const std::vector<double> &s = r.values;
+    std::cout << "Сервер: запросов " << s[0] << ", пакетов " << s[1] << ", запросов в пакетах " << s[2]
+            << ", очередь " << s[3] << "\n";
+    std::cout << "Задержка сервера, мкс: p50 " << s[4] << ", p90 " << s[5] << ", p99 " << s[6]
+            << ", max " << s[7] << "\n";
+}
+
+} // namespace job_server
+
+/**
+ * @brief Клиент сервера вычислительных ядер.
+ *
+ * Использование: numerics_client [--socket=PATH] check | stats |
+ *                bench [--connections=N] [--requests=N] [--points=N] [--window=N]
+ * check - проверка всех ядер (код возврата 1 при несовпадении),
+ * bench - нагрузочный тест с задержками, stats - статистика сервера.
+*/
+int main(int argc, char **argv) {
+    std::string socket_path = job_server::default_socket_path;
+    std::string command;
+    int connections = 8, requests = 20000, points = 16, window = 16;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        try {
+            if (name == "--socket") {
+                socket_path = value;
+            } else if (name == "--connections") {
+                connections = std::max(1, std::stoi(value));
+            } else if (name == "--requests") {
+                requests = std::max(1, std::stoi(value));
+            } else if (name == "--points") {
+                points = std::max(1, std::stoi(value));
+            } else if (name == "--window") {
+                window = std::max(1, std::stoi(value));
+            } else if (arg == "check" || arg == "stats" || arg == "bench") {
+                command = arg;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception &) {
+            std::cerr << "неизвестный или некорректный аргумент " << arg << "\n";
+            return 1;
+        }
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        if (command == "check") {
+            return job_server::check(socket_path) == 0 ? 0 : 1;
+        } else if (command == "bench") {
+            job_server::bench(socket_path, connections, requests, points, window);
+            job_server::stats(socket_path);
+        } else if (command == "stats") {
+            job_server::stats(socket_path);
+        } else {
+            std::cerr << "использование: numerics_client [--socket=PATH] check | stats | bench [--connections=N] "
+                    "[--requests=N] [--points=N] [--window=N]\n";
+            return 1;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
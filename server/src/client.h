@@ -0,0 +1,77 @@
+#ifndef JOB_SERVER_CLIENT_H
+#define JOB_SERVER_CLIENT_H
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "protocol.h"
+
+namespace job_server {
+
+/**
+ * @brief Блокирующий клиент сервера вычислительных ядер.
+ *
+ * call(r) - запрос и ожидание ответа; send/receive позволяют держать
+ * несколько запросов в полете на одном соединении (ответы сопоставляются по id).
+ * Один объект client нельзя использовать из нескольких потоков одновременно.
+*/
+class client {
+public:
+    explicit client(const std::string &socket_path = default_socket_path)
+        : fd_(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            ::close(fd_);
+            throw std::runtime_error("слишком длинный путь сокета " + socket_path);
+        }
+        std::strcpy(address.sun_path, socket_path.c_str());
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            const std::string reason = std::strerror(errno);
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            throw std::runtime_error("нет соединения с " + socket_path + ": " + reason);
+        }
+    }
+
+    ~client() {
+        ::close(fd_);
+    }
+
+    client(const client &) = delete;
+    client &operator=(const client &) = delete;
+
+    void send(const request &r) {
+        buffer_.clear();
+        encode(r, buffer_);
+        write_all(fd_, buffer_);
+    }
+
+    response receive() {
+        read_frame(fd_, buffer_);
+        response r;
+        if (!decode(buffer_.data(), buffer_.size(), r)) {
+            throw std::runtime_error("некорректный кадр ответа");
+        }
+        return r;
+    }
+
+    response call(const request &r) {
+        send(r);
+        return receive();
+    }
+
+private:
+    int fd_;
+    std::string buffer_;
+};
+
+} // namespace job_server
+
+#endif
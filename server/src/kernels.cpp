@@ -0,0 +1,243 @@
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "chebyshev.h"
+#include "interpolation.h"
+#include "quadrature.h"
+#include "series.h"
+
+namespace job_server {
+
+namespace {
+
+const int max_series_terms = 1000;
+const int max_partitions = 100000000;
+// Таблица разделенных разностей - плотная m x m (8 МБ при m = 1000), сплайн ищет
+// отрезок перебором узлов: без ограничения m один запрос съедает память или поток
+const int max_interpolation_nodes = 1000;
+
+/**
+ * @brief Бюджет поиска корней на один запрос: при исчерпании chebyshev_fit бросает
+ * исключение, и клиент получает status_error, а рабочий поток освобождается.
+*/
+const numerics::chebyshev_settings roots_settings = {1e-13, 128, 1e-10, 2000, 200000};
+
+/**
+ * @brief Запас до переполнения: |слагаемое| <= e^700 < DBL_MAX ~ e^709.
+*/
+const double max_log_magnitude = 700.0;
+
+bool valid_series(const request &r) {
+    return r.kernel == kernel_series && r.op <= 1 && r.ints.size() == 1
+           && r.ints[0] >= 1 && r.ints[0] <= max_series_terms;
+}
+
+/**
+ * @brief Отрезок [a,b] из первых двух doubles запроса.
+*/
+void read_interval(const request &r, double &a, double &b) {
+    if (r.doubles.size() < 2) {
+        throw bad_request("нужны границы отрезка a и b");
+    }
+    a = r.doubles[0];
+    b = r.doubles[1];
+    if (!std::isfinite(a) || !std::isfinite(b) || !(a < b)) {
+        throw bad_request("нужны конечные a < b");
+    }
+}
+
+/**
+ * @brief bad_request, если какое-то слагаемое может переполнить double на [a,b].
+ *
+ * Оценка сверху: ln|c| + power ln X + max(-alpha x^2) при X = max(|a|, |b|);
+ * при alpha < 0 экспонента растет и достигает максимума на конце отрезка.
+ * Без проверки f = inf почти всюду, и поиск корней и квадратуры бессмысленны.
+*/
+void check_overflow(const std::vector<term> &terms, const double a, const double b) {
+    const double X = std::max(std::fabs(a), std::fabs(b));
+    for (const term &t: terms) {
+        if (t.c == 0.0) {
+            continue;
+        }
+        double bound = std::log(std::fabs(t.c));
+        if (t.power > 0 && X > 1.0) {
+            bound += t.power * std::log(X);
+        }
+        if (t.alpha < 0.0) {
+            bound -= t.alpha * X * X;
+        }
+        if (!(bound <= max_log_magnitude)) {
+            throw bad_request("слагаемое переполняет double на [a,b] (слишком большие c, power или -alpha)");
+        }
+    }
+}
+
+std::vector<double> integrate(const request &r) {
+    double a, b;
+    read_interval(r, a, b);
+    if (r.ints.size() != 1 || r.ints[0] < 1 || r.ints[0] > max_partitions) {
+        throw bad_request("ints = {n}, 1 <= n <= 1e8");
+    }
+    const int n = r.ints[0];
+    const std::vector<term> terms = parse_terms(r.doubles, 2);
+    check_overflow(terms, a, b);
+    const numerics::batch_function f = [&terms](const double *x, double *y, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            y[i] = evaluate_terms(terms, x[i]);
+        }
+    };
+
+    double I;
+    switch (r.op) {
+        case method_rectangle:
+            I = numerics::rectangle_method(f, a, b, n);
+            break;
+        case method_trapezoidal:
+            I = numerics::trapezoidal_method(f, a, b, n);
+            break;
+        case method_simpson:
+            I = numerics::simpson_method(f, a, b, n);
+            break;
+        case method_three_eights:
+            I = numerics::three_eights_method(f, a, b, n);
+            break;
+        case method_gauss_legendre:
+            if (n > 1000) {
+                throw bad_request("квадратура Гаусса: не больше 1000 узлов");
+            }
+            I = numerics::gauss_legendre(f, a, b, n);
+            break;
+        default:
+            throw bad_request("неизвестный метод интегрирования");
+    }
+    return std::vector<double>(1, I);
+}
+
+std::vector<double> roots(const request &r) {
+    double a, b;
+    read_interval(r, a, b);
+    const std::vector<term> terms = parse_terms(r.doubles, 2);
+    check_overflow(terms, a, b);
+    return numerics::chebyshev_roots([&terms](double x) { return evaluate_terms(terms, x); }, a, b,
+                                     roots_settings);
+}
+
+std::vector<double> interpolate(const request &r) {
+    if (r.ints.size() != 1 || r.ints[0] < 2 || r.ints[0] > max_interpolation_nodes
+        || 2 * static_cast<std::size_t>(r.ints[0]) > r.doubles.size()) {
+        throw bad_request("ints = {m}, 2 <= m <= 1000, doubles = {x[m], y[m], точки...}");
+    }
+    const std::size_t m = r.ints[0];
+    const std::vector<double> x(r.doubles.begin(), r.doubles.begin() + m);
+    const std::vector<double> y(r.doubles.begin() + m, r.doubles.begin() + 2 * m);
+    for (std::size_t i = 1; i < m; i++) {
+        if (!(x[i - 1] < x[i])) {
+            throw bad_request("узлы интерполяции должны возрастать");
+        }
+    }
+    const double *points = r.doubles.data() + 2 * m;
+    const std::size_t count = r.doubles.size() - 2 * m;
+    std::vector<double> values(count);
+
+    if (r.op == 0) {
+        const std::vector<std::vector<double> > diff = numerics::divided_differences(x, y);
+        numerics::newton_interpolation(points, values.data(), count, x, diff);
+    } else if (r.op == 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            values[i] = numerics::linear_spline(points[i], x, y);
+        }
+    } else {
+        throw bad_request("неизвестный метод интерполяции");
+    }
+    return values;
+}
+
+} // namespace
+
+std::vector<term> parse_terms(const std::vector<double> &doubles, const std::size_t first) {
+    if (doubles.size() < first || (doubles.size() - first) % term_doubles != 0) {
+        throw bad_request("слагаемые функции - по 5 чисел: c, power, alpha, omega, phi");
+    }
+    std::vector<term> terms;
+    for (std::size_t i = first; i < doubles.size(); i += term_doubles) {
+        const double power = doubles[i + 1];
+        if (!(power >= 0.0 && power <= 64.0) || power != std::floor(power)) {
+            throw bad_request("степень слагаемого должна быть целой от 0 до 64");
+        }
+        if (!std::isfinite(doubles[i]) || !std::isfinite(doubles[i + 2]) || !std::isfinite(doubles[i + 3])
+            || !std::isfinite(doubles[i + 4])) {
+            throw bad_request("параметры слагаемого должны быть конечными");
+        }
+        term t = {doubles[i], static_cast<int>(power), doubles[i + 2], doubles[i + 3], doubles[i + 4]};
+        terms.push_back(t);
+    }
+    return terms;
+}
+
+double evaluate_terms(const std::vector<term> &terms, const double x) {
+    double sum = 0.0;
+    for (const term &t: terms) {
+        double v = t.c;
+        for (int k = 0; k < t.power; k++) {
+            v *= x;
+        }
+        if (t.alpha != 0.0) {
+            v *= std::exp(-t.alpha * x * x);
+        }
+        if (t.omega != 0.0 || t.phi != 0.0) {
+            v *= std::cos(t.omega * x + t.phi);
+        }
+        sum += v;
+    }
+    return sum;
+}
+
+bool batchable(const request &a, const request &b) {
+    return valid_series(a) && valid_series(b) && a.op == b.op && a.ints[0] == b.ints[0];
+}
+
+void run_batch(const std::vector<const request *> &batch, std::vector<std::vector<double> > &values) {
+    values.assign(batch.size(), std::vector<double>());
+    const request &first = *batch.front();
+
+    switch (first.kernel) {
+        case kernel_series: {
+            if (!valid_series(first)) {
+                throw bad_request("ints = {n_terms}, 1 <= n_terms <= 1000, op: 0 - sin, 1 - exp");
+            }
+            // Точки всех запросов пакета - один массив для векторизованного ядра
+            std::vector<double> t;
+            for (const request *r: batch) {
+                t.insert(t.end(), r->doubles.begin(), r->doubles.end());
+            }
+            std::vector<double> out(t.size());
+            if (first.op == 0) {
+                numerics::maclaurin_sin(t.data(), out.data(), t.size(), first.ints[0]);
+            } else {
+                numerics::maclaurin_exp(t.data(), out.data(), t.size(), first.ints[0]);
+            }
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                const std::size_t n = batch[i]->doubles.size();
+                values[i].assign(out.begin() + offset, out.begin() + offset + n);
+                offset += n;
+            }
+            return;
+        }
+        case kernel_integrate:
+            values[0] = integrate(first);
+            return;
+        case kernel_roots:
+            values[0] = roots(first);
+            return;
+        case kernel_interpolate:
+            values[0] = interpolate(first);
+            return;
+        default:
+            throw bad_request("неизвестное ядро");
+    }
+}
+
+} // namespace job_server
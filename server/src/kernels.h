@@ -0,0 +1,74 @@
+#ifndef JOB_SERVER_KERNELS_H
+#define JOB_SERVER_KERNELS_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+
+namespace job_server {
+
+/**
+ * @brief Некорректный запрос: клиент получит status_bad_request и текст ошибки.
+*/
+class bad_request : public std::invalid_argument {
+public:
+    explicit bad_request(const std::string &what)
+        : std::invalid_argument(what) {
+    }
+};
+
+/**
+ * @brief Слагаемое функции для интегрирования и поиска корней:
+ * c * x^power * exp(-alpha * x^2) * cos(omega * x + phi).
+ *
+ * По сети передается пятью double подряд; power - целое от 0 до 64.
+ * Сумма таких слагаемых покрывает функции заданий (например, подынтегральная
+ * функция task_2 sin(100x) exp(-x^2) cos(2x) - два слагаемых с omega = 98 и 102).
+*/
+struct term {
+    double c;
+    int power;
+    double alpha;
+    double omega;
+    double phi;
+};
+
+const std::size_t term_doubles = 5;
+
+/**
+ * @brief Сумма слагаемых из doubles[first..]: bad_request, если длина не кратна
+ * term_doubles, power не целое из [0, 64] или параметр не конечен.
+*/
+std::vector<term> parse_terms(const std::vector<double> &doubles, std::size_t first);
+
+/**
+ * @brief f(x) = сумма слагаемых в точке x.
+*/
+double evaluate_terms(const std::vector<term> &terms, double x);
+
+/**
+ * @brief Можно ли вычислить запросы одним пакетным вызовом ядра.
+ *
+ * Так объединяются запросы kernel_series с одинаковыми op и n_terms:
+ * их точки склеиваются в один массив, и векторизованная сумма ряда
+ * обрабатывает их за один проход.
+*/
+bool batchable(const request &a, const request &b);
+
+/**
+ * @brief Выполнение пакета совместимых запросов (batchable попарно).
+ *
+ * @param batch запросы пакета.
+ * @param values values[i] - результат batch[i] (выходной параметр).
+ *
+ * Ошибка в параметрах - исключение bad_request; пакеты из нескольких запросов
+ * проверяются заранее, поэтому исключение возможно только у пакета из одного.
+*/
+void run_batch(const std::vector<const request *> &batch, std::vector<std::vector<double> > &values);
+
+} // namespace job_server
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef JOB_SERVER_LATENCY_H
+#define JOB_SERVER_LATENCY_H
+
+#include <cstdint>
+#include <vector>
+
+namespace job_server {
+
+/**
+ * @brief Гистограмма задержек в микросекундах: 4 корзины на октаву
+ * (относительная погрешность перцентилей не больше 25%), память O(1).
+ *
+ * Не потокобезопасна: сервер обновляет ее под своим мьютексом, клиент
+ * заводит по гистограмме на поток и складывает их через merge.
+*/
+class latency_histogram {
+public:
+    latency_histogram()
+        : buckets_(bucket_count, 0), count_(0), max_(0) {
+    }
+
+    void add(const std::uint64_t us) {
+        buckets_[bucket(us)]++;
+        count_++;
+        if (us > max_) {
+            max_ = us;
+        }
+    }
+
+    void merge(const latency_histogram &other) {
+        for (int b = 0; b < bucket_count; b++) {
+            buckets_[b] += other.buckets_[b];
+        }
+        count_ += other.count_;
+        if (other.max_ > max_) {
+            max_ = other.max_;
+        }
+    }
+
+    std::uint64_t count() const {
+        return count_;
+    }
+
+    std::uint64_t max() const {
+        return max_;
+    }
+
+    /**
+     * @brief Перцентиль q из [0, 1]: верхняя граница корзины, в которую он попал.
+    */
+    double percentile(const double q) const {
+        const double target = q * static_cast<double>(count_);
+        std::uint64_t seen = 0;
+        for (int b = 0; b < bucket_count; b++) {
+            seen += buckets_[b];
+            if (seen > 0 && static_cast<double>(seen) >= target) {
+                const std::uint64_t bound = upper(b);
+                return static_cast<double>(bound < max_ ? bound : max_);
+            }
+        }
+        return static_cast<double>(max_);
+    }
+
+private:
+    static const int bucket_count = 252;
+
+    /**
+     * @brief Номер корзины: us < 4 - своя корзина, иначе 2 старших бита
+     * после ведущей единицы делят октаву [2^e, 2^(e+1)) на 4 части.
+    */
+    static int bucket(const std::uint64_t us) {
+        if (us < 4) {
+            return static_cast<int>(us);
+        }
+        const int e = 63 - __builtin_clzll(us);
+        return 4 * (e - 1) + static_cast<int>((us >> (e - 2)) - 4);
+    }
+
+    static std::uint64_t upper(const int b) {
+        if (b < 4) {
+            return static_cast<std::uint64_t>(b);
+        }
+        const int e = b / 4 + 1;
+        const std::uint64_t sub = b % 4;
+        return ((5 + sub) << (e - 2)) - 1;
+    }
+
+    std::vector<std::uint64_t> buckets_;
+    std::uint64_t count_;
+    std::uint64_t max_;
+};
+
+} // namespace job_server
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef JOB_SERVER_PROTOCOL_H
+#define JOB_SERVER_PROTOCOL_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/**
+ * @brief Двоичный протокол сервера вычислительных ядер (Unix-сокет).
+ *
+ * Каждое сообщение - кадр: u32 длина остатка кадра, затем поля в порядке
+ * little-endian без выравнивания.
+ *
+ * Запрос:  u32 id, u8 kernel, u8 op, u16 0, u32 n_ints, u32 n_doubles,
+ *          i32[n_ints], f64[n_doubles].
+ * Ответ:   u32 id, u8 status, u8[3] 0, u32 queue_us, u32 compute_us, u32 n,
+ *          f64[n] при status_ok, иначе n байт текста ошибки (UTF-8).
+ *
+ * id выбирает клиент и получает обратно: по одному соединению можно
+ * отправить много запросов, не дожидаясь ответов, и ответы могут прийти
+ * в другом порядке. queue_us и compute_us - время ожидания в очереди
+ * и вычисления на сервере в микросекундах.
+*/
+namespace job_server {
+
+const char *const default_socket_path = "/tmp/computational-mathematics.sock";
+
+/**
+ * @brief Наибольшая длина кадра: защищает сервер от некорректной длины.
+*/
+const std::uint32_t max_frame_size = 64u << 20;
+
+/**
+ * @brief Вычислительные ядра. Параметры (ints, doubles) и результат values:
+ *
+ * kernel_stats - статистика сервера, values = {запросов, пакетов, запросов в пакетах,
+ *   длина очереди, p50, p90, p99, max задержки в мкс}.
+ * kernel_series - частичные суммы Маклорена, op: 0 - sin, 1 - exp;
+ *   ints = {n_terms}, doubles = точки t, values - суммы в этих точках.
+ * kernel_integrate - интеграл суммы слагаемых (см. kernels.h), op - метод
+ *   (quadrature_method); ints = {n}, doubles = {a, b, слагаемые...}, values = {I};
+ *   слагаемые проверяются на переполнение, как в kernel_roots.
+ * kernel_roots - все корни суммы слагаемых на [a,b] (numerics::chebyshev_roots);
+ *   doubles = {a, b, слагаемые...}, values - корни по возрастанию. Слагаемые, которые
+ *   переполняют double на [a,b], - status_bad_request; исчерпан бюджет кусков
+ *   аппроксимации (2000 кусков, 2e5 вычислений f) - status_error.
+ * kernel_interpolate - op: 0 - полином Ньютона, 1 - линейный сплайн;
+ *   ints = {m}, 2 <= m <= 1000, doubles = {x[m], y[m], точки...}, values - значения в точках.
+*/
+enum kernel : std::uint8_t {
+    kernel_stats = 0,
+    kernel_series = 1,
+    kernel_integrate = 2,
+    kernel_roots = 3,
+    kernel_interpolate = 4,
+};
+
+enum quadrature_method : std::uint8_t {
+    method_rectangle = 0,
+    method_trapezoidal = 1,
+    method_simpson = 2,
+    method_three_eights = 3,
+    method_gauss_legendre = 4,
+};
+
+enum status : std::uint8_t {
+    status_ok = 0,
+    status_bad_request = 1,
+    status_error = 2,
+};
+
+struct request {
+    std::uint32_t id;
+    std::uint8_t kernel;
+    std::uint8_t op;
+    std::vector<std::int32_t> ints;
+    std::vector<double> doubles;
+};
+
+struct response {
+    std::uint32_t id;
+    std::uint8_t status;
+    std::uint32_t queue_us;
+    std::uint32_t compute_us;
+    std::vector<double> values;
+    std::string message;
+};
+
+const std::size_t request_header_size = 16;
+const std::size_t response_header_size = 20;
+
+namespace detail {
+
+template <class T>
+void put(std::string &out, const T &value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+T get(const char *&p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+} // namespace detail
+
+/**
+ * @brief Длина кадра, начинающегося с data (с полем длины), или 0, если
+ * получено меньше 4 байт. Кадр длиннее max_frame_size - std::runtime_error.
+*/
+inline std::size_t frame_size(const char *data, const std::size_t available) {
+    if (available < 4) {
+        return 0;
+    }
+    std::uint32_t size;
+    std::memcpy(&size, data, 4);
+    if (size > max_frame_size) {
+        throw std::runtime_error("кадр длиннее max_frame_size");
+    }
+    return size + 4;
+}
+
+inline void encode(const request &r, std::string &out) {
+    using detail::put;
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(request_header_size + 4 * r.ints.size() + 8 * r.doubles.size()));
+    put<std::uint32_t>(out, r.id);
+    put<std::uint8_t>(out, r.kernel);
+    put<std::uint8_t>(out, r.op);
+    put<std::uint16_t>(out, 0);
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(r.ints.size()));
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(r.doubles.size()));
+    out.append(reinterpret_cast<const char *>(r.ints.data()), 4 * r.ints.size());
+    out.append(reinterpret_cast<const char *>(r.doubles.data()), 8 * r.doubles.size());
+}
+
+inline void encode(const response &r, std::string &out) {
+    using detail::put;
+    const bool ok = r.status == status_ok;
+    const std::size_t n = ok ? r.values.size() : r.message.size();
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(response_header_size + (ok ? 8 * n : n)));
+    put<std::uint32_t>(out, r.id);
+    put<std::uint8_t>(out, r.status);
+    out.append(3, '\0');
+    put<std::uint32_t>(out, r.queue_us);
+    put<std::uint32_t>(out, r.compute_us);
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(n));
+    if (ok) {
+        out.append(reinterpret_cast<const char *>(r.values.data()), 8 * n);
+    } else {
+        out.append(r.message);
+    }
+}
+
+/**
+ * @brief Разбор кадра запроса (frame - без поля длины).
+ *
+ * @return false, если длины массивов не согласуются с длиной кадра.
+*/
+inline bool decode(const char *frame, const std::size_t size, request &r) {
+    using detail::get;
+    if (size < request_header_size) {
+        return false;
+    }
+    const char *p = frame;
+    r.id = get<std::uint32_t>(p);
+    r.kernel = get<std::uint8_t>(p);
+    r.op = get<std::uint8_t>(p);
+    get<std::uint16_t>(p);
+    const std::uint64_t n_ints = get<std::uint32_t>(p);
+    const std::uint64_t n_doubles = get<std::uint32_t>(p);
+    if (request_header_size + 4 * n_ints + 8 * n_doubles != size) {
+        return false;
+    }
+    r.ints.resize(n_ints);
+    r.doubles.resize(n_doubles);
+    std::memcpy(r.ints.data(), p, 4 * n_ints);
+    std::memcpy(r.doubles.data(), p + 4 * n_ints, 8 * n_doubles);
+    return true;
+}
+
+inline bool decode(const char *frame, const std::size_t size, response &r) {
+    using detail::get;
+    if (size < response_header_size) {
+        return false;
+    }
+    const char *p = frame;
+    r.id = get<std::uint32_t>(p);
+    r.status = get<std::uint8_t>(p);
+    p += 3;
+    r.queue_us = get<std::uint32_t>(p);
+    r.compute_us = get<std::uint32_t>(p);
+    const std::uint64_t n = get<std::uint32_t>(p);
+    r.values.clear();
+    r.message.clear();
+    if (r.status == status_ok) {
+        if (response_header_size + 8 * n != size) {
+            return false;
+        }
+        r.values.resize(n);
+        std::memcpy(r.values.data(), p, 8 * n);
+    } else {
+        if (response_header_size + n != size) {
+            return false;
+        }
+        r.message.assign(p, n);
+    }
+    return true;
+}
+
+/**
+ * @brief Запись всего буфера в блокирующий дескриптор.
+*/
+inline void write_all(const int fd, const std::string &data) {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error(std::string("запись в сокет: ") + std::strerror(errno));
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+/**
+ * @brief Чтение одного кадра из блокирующего дескриптора (frame - без поля длины).
+*/
+inline void read_frame(const int fd, std::string &frame) {
+    auto read_exact = [fd](char *data, std::size_t size) {
+        while (size > 0) {
+            const ssize_t n = ::read(fd, data, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::runtime_error(n == 0 ? "сервер закрыл соединение"
+                                                : std::string("чтение из сокета: ") + std::strerror(errno));
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    };
+    std::uint32_t size;
+    read_exact(reinterpret_cast<char *>(&size), 4);
+    if (size > max_frame_size) {
+        throw std::runtime_error("кадр длиннее max_frame_size");
+    }
+    frame.resize(size);
+    read_exact(&frame[0], size);
+}
+
+} // namespace job_server
+
+#endif
@@ -0,0 +1,576 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dispatch.h"
+#include "kernels.h"
+#include "latency.h"
+#include "metrics.h"
+#include "protocol.h"
+
+namespace job_server {
+
+typedef std::chrono::steady_clock server_clock;
+
+/**
+ * @brief Параметры сервера (флаги командной строки).
+ *
+ * queue_limit - сколько запросов может ждать в очереди: при заполнении сервер
+ * перестает читать сокеты, и клиенты упираются в полный буфер сокета.
+ * max_batch_points - сколько точек kernel_series склеивается в один пакет.
+*/
+struct settings {
+    std::string socket_path;
+    int threads;
+    std::size_t queue_limit;
+    std::size_t max_batch_points;
+};
+
+/**
+ * @brief Сколько байт ответов может ждать отправки одному клиенту, пока
+ * сервер еще читает его запросы (клиент, не читающий ответы, не растит память).
+*/
+const std::size_t output_limit = 16u << 20;
+
+/**
+ * @brief Сколько при остановке ждать, пока клиенты примут готовые ответы.
+*/
+const std::chrono::seconds shutdown_timeout(5);
+
+volatile std::sig_atomic_t stop_requested = 0;
+int signal_wake_fd = -1;
+
+void on_signal(int) {
+    stop_requested = 1;
+    const char byte = 0;
+    if (::write(signal_wake_fd, &byte, 1) < 0) {
+        // Канал полон - цикл и так проснется
+    }
+}
+
+std::uint32_t microseconds(const server_clock::duration d) {
+    const long long us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return us > 0xFFFFFFFFLL ? 0xFFFFFFFFu : static_cast<std::uint32_t>(us);
+}
+
+/**
+ * @brief Сервер вычислительных ядер.
+ *
+ * Поток ввода-вывода (run) принимает соединения, собирает кадры запросов
+ * и кладет их в общую очередь; рабочие потоки забирают запросы, объединяя
+ * совместимые (batchable) в один вызов ядра, и возвращают готовые ответы
+ * через очередь completed_ - сокетами владеет только поток ввода-вывода.
+*/
+class server {
+public:
+    explicit server(const settings &options)
+        : options_(options), listen_fd_(-1), stopping_(false), requests_(0), batches_(0), batched_requests_(0) {
+        int pipe_fds[2];
+        if (::pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+            throw std::runtime_error("pipe2: не удалось создать канал пробуждения");
+        }
+        wake_read_ = pipe_fds[0];
+        wake_write_ = pipe_fds[1];
+        listen();
+    }
+
+    ~server() {
+        for (auto &entry: connections_) {
+            ::close(entry.second.fd);
+        }
+        ::close(listen_fd_);
+        ::close(wake_read_);
+        ::close(wake_write_);
+        ::unlink(options_.socket_path.c_str());
+    }
+
+    int wake_fd() const {
+        return wake_write_;
+    }
+
+    /**
+     * @brief Цикл ввода-вывода до сигнала остановки; затем рабочие потоки
+     * дорабатывают очередь, и ответы на все принятые запросы отправляются
+     * клиентам до закрытия сокетов.
+    */
+    void run() {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < options_.threads; i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<std::uint64_t> ids;
+        while (!stop_requested) {
+            deliver_completed();
+
+            const bool reading = queue_size() < options_.queue_limit;
+            fds.clear();
+            ids.clear();
+            fds.push_back({wake_read_, POLLIN, 0});
+            fds.push_back({listen_fd_, POLLIN, 0});
+            for (const auto &entry: connections_) {
+                short events = 0;
+                if (reading && entry.second.out.size() < output_limit) {
+                    events |= POLLIN;
+                }
+                if (!entry.second.out.empty()) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({entry.second.fd, events, 0});
+                ids.push_back(entry.first);
+            }
+
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+            }
+            if (fds[0].revents & POLLIN) {
+                char buffer[256];
+                while (::read(wake_read_, buffer, sizeof(buffer)) > 0) {
+                }
+            }
+            if (fds[1].revents & POLLIN) {
+                accept_clients();
+            }
+            for (std::size_t i = 0; i < ids.size(); i++) {
+                const short revents = fds[i + 2].revents;
+                auto it = connections_.find(ids[i]);
+                bool open = true;
+                if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                    open = read_client(ids[i], it->second);
+                }
+                if (open && (revents & POLLOUT)) {
+                    open = flush_client(it->second);
+                }
+                if (!open) {
+                    ::close(it->second.fd);
+                    connections_.erase(it);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_ready_.notify_all();
+        for (std::thread &t: workers) {
+            t.join();
+        }
+        flush_on_shutdown();
+        print_stats();
+    }
+
+private:
+    struct connection {
+        int fd;
+        std::string in;
+        std::string out;
+    };
+
+    struct pending {
+        std::uint64_t connection;
+        request req;
+        server_clock::time_point received;
+    };
+
+    struct completed {
+        std::uint64_t connection;
+        std::string bytes;
+    };
+
+    void listen() {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (options_.socket_path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("слишком длинный путь сокета " + options_.socket_path);
+        }
+        std::strcpy(address.sun_path, options_.socket_path.c_str());
+
+        // Сокет от упавшего сервера удаляется, от работающего - нет
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (::connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+            ::close(probe);
+            throw std::runtime_error("сервер уже запущен на " + options_.socket_path);
+        }
+        ::close(probe);
+        ::unlink(options_.socket_path.c_str());
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+            || ::listen(listen_fd_, 128) != 0) {
+            throw std::runtime_error("не удалось открыть сокет " + options_.socket_path + ": " + std::strerror(errno));
+        }
+    }
+
+    void wake() {
+        const char byte = 0;
+        if (::write(wake_write_, &byte, 1) < 0) {
+            // Канал полон - поток ввода-вывода и так проснется
+        }
+    }
+
+    std::size_t queue_size() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return queue_.size();
+    }
+
+    void accept_clients() {
+        while (true) {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            connection c = {fd, std::string(), std::string()};
+            connections_[next_connection_++] = c;
+            METRICS_COUNT("server.connections");
+        }
+    }
+
+    /**
+     * @brief Чтение всех доступных байт и разбор целых кадров.
+     *
+     * @return false, если клиент закрыл соединение или прислал кадр длиннее max_frame_size.
+    */
+    bool read_client(const std::uint64_t id, connection &c) {
+        char buffer[65536];
+        bool open = true;
+        while (true) {
+            const ssize_t n = ::read(c.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                c.in.append(buffer, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            open = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+
+        std::size_t offset = 0;
+        std::vector<pending> received;
+        const server_clock::time_point now = server_clock::now();
+        try {
+            while (true) {
+                const std::size_t size = frame_size(c.in.data() + offset, c.in.size() - offset);
+                if (size == 0 || c.in.size() - offset < size) {
+                    break;
+                }
+                pending p;
+                p.connection = id;
+                p.received = now;
+                if (decode(c.in.data() + offset + 4, size - 4, p.req)) {
+                    received.push_back(std::move(p));
+                } else {
+                    response error = {0, status_bad_request, 0, 0, std::vector<double>(), "некорректный кадр запроса"};
+                    if (size >= 8) {
+                        std::memcpy(&error.id, c.in.data() + offset + 4, 4);
+                    }
+                    encode(error, c.out);
+                }
+                offset += size;
+            }
+        } catch (const std::runtime_error &) {
+            return false;
+        }
+        c.in.erase(0, offset);
+
+        if (!received.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                for (pending &p: received) {
+                    queue_.push_back(std::move(p));
+                }
+            }
+            queue_ready_.notify_all();
+        }
+        return open;
+    }
+
+    bool flush_client(connection &c) {
+        while (!c.out.empty()) {
+            const ssize_t n = ::send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out.erase(0, static_cast<std::size_t>(n));
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            } else if (!(n < 0 && errno == EINTR)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void deliver_completed() {
+        std::vector<completed> ready;
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex_);
+            ready.swap(completed_);
+        }
+        for (completed &item: ready) {
+            auto it = connections_.find(item.connection);
+            if (it != connections_.end()) {
+                it->second.out += item.bytes;
+            }
+        }
+    }
+
+    /**
+     * @brief Отправка ответов, готовых к остановке (рабочие потоки уже завершены).
+     *
+     * Ждет, пока клиенты примут ответы, но не дольше shutdown_timeout: клиент,
+     * который не читает сокет, не задерживает остановку сервера.
+    */
+    void flush_on_shutdown() {
+        deliver_completed();
+        const server_clock::time_point deadline = server_clock::now() + shutdown_timeout;
+        std::vector<pollfd> fds;
+        std::vector<std::uint64_t> ids;
+        while (true) {
+            fds.clear();
+            ids.clear();
+            for (const auto &entry: connections_) {
+                if (!entry.second.out.empty()) {
+                    fds.push_back({entry.second.fd, POLLOUT, 0});
+                    ids.push_back(entry.first);
+                }
+            }
+            const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - server_clock::now()).count();
+            if (fds.empty() || left <= 0) {
+                return;
+            }
+            if (::poll(fds.data(), fds.size(), static_cast<int>(left)) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            for (std::size_t i = 0; i < ids.size(); i++) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                auto it = connections_.find(ids[i]);
+                if (!flush_client(it->second)) {
+                    ::close(it->second.fd);
+                    connections_.erase(it);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Рабочий поток: берет запрос и все уже ожидающие совместимые с ним.
+     *
+     * Пакет собирается только из того, что накопилось в очереди, без ожидания:
+     * при малой нагрузке задержка не растет, а под нагрузкой очередь длиннее
+     * и пакеты крупнее.
+    */
+    void work() {
+        std::vector<pending> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                queue_ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                batch.clear();
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+                std::size_t points = batch.front().req.doubles.size();
+                for (auto it = queue_.begin(); it != queue_.end() && points < options_.max_batch_points;) {
+                    if (batchable(batch.front().req, it->req)) {
+                        points += it->req.doubles.size();
+                        batch.push_back(std::move(*it));
+                        it = queue_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            // Очередь уменьшилась: поток ввода-вывода может снова читать сокеты
+            wake();
+            execute(batch);
+        }
+    }
+
+    void execute(const std::vector<pending> &batch) {
+        const server_clock::time_point start = server_clock::now();
+        std::vector<std::vector<double> > values;
+        std::uint8_t status = status_ok;
+        std::string message;
+        try {
+            if (batch.front().req.kernel == kernel_stats) {
+                values.assign(1, stats_snapshot());
+            } else {
+                std::vector<const request *> requests;
+                for (const pending &p: batch) {
+                    requests.push_back(&p.req);
+                }
+                run_batch(requests, values);
+            }
+        } catch (const bad_request &e) {
+            status = status_bad_request;
+            message = e.what();
+        } catch (const std::exception &e) {
+            status = status_error;
+            message = e.what();
+        }
+        const server_clock::time_point finish = server_clock::now();
+        METRICS_HISTOGRAM("server.batch_size", batch.size());
+
+        std::vector<completed> ready;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            requests_ += batch.size();
+            batches_++;
+            if (batch.size() > 1) {
+                batched_requests_ += batch.size();
+            }
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                response r;
+                r.id = batch[i].req.id;
+                r.status = status;
+                r.queue_us = microseconds(start - batch[i].received);
+                r.compute_us = microseconds(finish - start);
+                if (status == status_ok) {
+                    r.values.swap(values[i]);
+                } else {
+                    r.message = message;
+                }
+                latency_.add(static_cast<std::uint64_t>(r.queue_us) + r.compute_us);
+                METRICS_HISTOGRAM("server.latency_us", static_cast<double>(r.queue_us) + r.compute_us);
+
+                completed item = {batch[i].connection, std::string()};
+                encode(r, item.bytes);
+                ready.push_back(std::move(item));
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex_);
+            for (completed &item: ready) {
+                completed_.push_back(std::move(item));
+            }
+        }
+        wake();
+    }
+
+    std::vector<double> stats_snapshot() {
+        const double depth = static_cast<double>(queue_size());
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return {
+            static_cast<double>(requests_), static_cast<double>(batches_), static_cast<double>(batched_requests_),
+            depth, latency_.percentile(0.5), latency_.percentile(0.9), latency_.percentile(0.99),
+            static_cast<double>(latency_.max())
+        };
+    }
+
+    void print_stats() {
+        const std::vector<double> s = stats_snapshot();
+        std::cout << "Запросов: " << s[0] << ", пакетов: " << s[1] << ", запросов в пакетах: " << s[2] << "\n";
+        std::cout << "Задержка, мкс: p50 " << s[4] << ", p90 " << s[5] << ", p99 " << s[6] << ", max " << s[7] << "\n";
+    }
+
+    settings options_;
+    int listen_fd_;
+    int wake_read_;
+    int wake_write_;
+
+    std::map<std::uint64_t, connection> connections_;
+    std::uint64_t next_connection_ = 0;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_ready_;
+    std::deque<pending> queue_;
+    bool stopping_;
+
+    std::mutex completed_mutex_;
+    std::vector<completed> completed_;
+
+    std::mutex stats_mutex_;
+    std::uint64_t requests_;
+    std::uint64_t batches_;
+    std::uint64_t batched_requests_;
+    latency_histogram latency_;
+};
+
+} // namespace job_server
+
+/**
+ * @brief Сервер вычислительных ядер numerics на Unix-сокете.
+ *
+ * Использование: numerics_server [--socket=PATH] [--threads=N] [--queue=N] [--batch-points=N]
+ * По умолчанию сокет job_server::default_socket_path, потоков - по числу ядер,
+ * очередь 1024 запроса, пакет до 65536 точек. Останавливается по SIGINT/SIGTERM:
+ * принятые запросы досчитываются, ответы отправляются (не дольше 5 с).
+*/
+int main(int argc, char **argv) {
+    job_server::settings options;
+    options.socket_path = job_server::default_socket_path;
+    options.threads = static_cast<int>(std::thread::hardware_concurrency());
+    options.queue_limit = 1024;
+    options.max_batch_points = 65536;
+    if (options.threads < 1) {
+        options.threads = 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        try {
+            if (name == "--socket") {
+                options.socket_path = value;
+            } else if (name == "--threads") {
+                options.threads = std::max(1, std::stoi(value));
+            } else if (name == "--queue") {
+                options.queue_limit = std::max(1, std::stoi(value));
+            } else if (name == "--batch-points") {
+                options.max_batch_points = std::max(1, std::stoi(value));
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception &) {
+            std::cerr << "неизвестный или некорректный аргумент " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        job_server::server server(options);
+        job_server::signal_wake_fd = server.wake_fd();
+        std::signal(SIGINT, job_server::on_signal);
+        std::signal(SIGTERM, job_server::on_signal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        std::cout << "Сокет: " << options.socket_path << ", потоков: " << options.threads
+                << ", очередь: " << options.queue_limit << ", ядра: " << numerics::active_isa() << std::endl;
+        server.run();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -3,7 +3,7 @@
 echo "=== Building C++ Data Generator ==="
 
 # Сборка C++ проекта
-g++ -std=c++11 -O2 -o data_generator src/main.cpp -lm
+g++ -std=c++17 -O2 $CXXFLAGS -ffp-contract=off -I../../common -I../../numerics -o data_generator src/main.cpp ../../numerics/*.cpp -lm -pthread
 
 echo "=== Generating Data ==="
 ./data_generator
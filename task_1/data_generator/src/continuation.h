@@ -0,0 +1,330 @@
+#ifndef CONTINUATION_H
+#define CONTINUATION_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "autodiff.h"
+#include "metrics.h"
+
+/**
+ * @brief Параметры семейства систем x^2 + y^2 = r^2, y = tg(k x).
+*/
+struct system_params {
+    double r;
+    double k;
+};
+
+/**
+ * @brief Точка на ветви решений: параметр lambda in [0, 1] и корень x.
+*/
+struct branch_point {
+    double lambda;
+    double x;
+};
+
+/**
+ * @brief Ветвь корней, прослеженная по параметру.
+ *
+ * points - последовательность точек ветви.
+ * turning_points - точки поворота (dlambda/ds меняет знак).
+ * complete - true, если ветвь дошла до границы lambda = 0 или lambda = 1.
+*/
+struct root_branch {
+    std::vector<branch_point> points;
+    std::vector<branch_point> turning_points;
+    bool complete;
+};
+
+/**
+ * @brief Настройки метода продолжения.
+ *
+ * h0, h_min, h_max - начальный, минимальный и максимальный шаг по длине дуги.
+ * epsilon - точность корректора.
+ * max_corrector_iterations - число итераций Ньютона на шаге корректора.
+ * max_steps - ограничение на число шагов вдоль одной ветви.
+*/
+struct continuation_settings {
+    double h0;
+    double h_min;
+    double h_max;
+    double epsilon;
+    int max_corrector_iterations;
+    int max_steps;
+};
+
+/**
+ * @brief Линейный путь по параметрам: p(lambda) = from + lambda * (to - from).
+*/
+struct parameter_path {
+    system_params from;
+    system_params to;
+
+    system_params at(const double lambda) const {
+        system_params p;
+        p.r = from.r + lambda * (to.r - from.r);
+        p.k = from.k + lambda * (to.k - from.k);
+        return p;
+    }
+};
+
+/**
+ * @brief Невязка H(x, lambda) = x^2 + tg^2(k x) - r^2 и её частные производные.
+ *
+ * H_x и H_lambda считаются автоматическим дифференцированием: H вычисляется
+ * один раз на numerics::dual<2> с переменными (x, lambda) через numerics::jacobian.
+*/
+inline void homotopy_residual(const parameter_path &path, const double x, const double lambda,
+                              double &H, double &H_x, double &H_lambda) {
+    typedef numerics::dual<2> var;
+    const std::array<double, 2> point = {x, lambda};
+    std::array<double, 1> value;
+    std::array<std::array<double, 2>, 1> J;
+    numerics::jacobian<1, 2>([&path](const std::array<var, 2> &v) {
+        const var r = path.from.r + v[1] * (path.to.r - path.from.r);
+        const var k = path.from.k + v[1] * (path.to.k - path.from.k);
+        const var t = tan(k * v[0]);
+        const std::array<var, 1> h = {v[0] * v[0] + t * t - r * r};
+        return h;
+    }, point, value, J);
+    H = value[0];
+    H_x = J[0][0];
+    H_lambda = J[0][1];
+}
+
+/**
+ * @brief Поиск корней H(x, lambda) = 0 при фиксированном lambda.
+ *
+ * @param path путь по параметрам.
+ * @param lambda значение параметра.
+ * @param a, b отрезок поиска.
+ * @param samples число узлов сетки для отделения корней.
+ * @param epsilon требуемая точность.
+ *
+ * Корни отделяются по смене знака H на сетке (у полюсов тангенса H
+ * стремится к +inf с обеих сторон, поэтому ложных смен знака нет)
+ * и уточняются методом Ньютона с защитой бисекцией.
+*/
+inline std::vector<double> find_start_roots(const parameter_path &path, const double lambda,
+                                            const double a, const double b, const int samples,
+                                            const double epsilon) {
+    std::vector<double> roots;
+    const double step = (b - a) / samples;
+    double H, H_x, H_lambda;
+
+    homotopy_residual(path, a, lambda, H, H_x, H_lambda);
+    double x_prev = a;
+    double H_prev = H;
+
+    for (int i = 1; i <= samples; i++) {
+        const double x_cur = a + i * step;
+        homotopy_residual(path, x_cur, lambda, H, H_x, H_lambda);
+        const double H_cur = H;
+
+        if (std::isfinite(H_prev) && std::isfinite(H_cur) && H_prev * H_cur < 0) {
+            double lo = x_prev, hi = x_cur;
+            double x = 0.5 * (lo + hi);
+            for (int it = 0; it < 100 && hi - lo > epsilon; it++) {
+                homotopy_residual(path, x, lambda, H, H_x, H_lambda);
+                if ((H < 0) == (H_prev < 0)) {
+                    lo = x;
+                } else {
+                    hi = x;
+                }
+                double x_new = (fabs(H_x) > 1e-12) ? x - H / H_x : 0.5 * (lo + hi);
+                if (x_new <= lo || x_new >= hi) {
+                    x_new = 0.5 * (lo + hi);
+                }
+                if (fabs(x_new - x) < epsilon) {
+                    x = x_new;
+                    break;
+                }
+                x = x_new;
+            }
+            roots.push_back(x);
+        }
+        x_prev = x_cur;
+        H_prev = H_cur;
+    }
+    return roots;
+}
+
+/**
+ * @brief Корректор: метод Ньютона для расширенной системы
+ * H(x, lambda) = 0, tau . (z - z_pred) = 0.
+ *
+ * Возвращает число итераций или -1, если корректор не сошелся.
+*/
+inline int correct_point(const parameter_path &path, const double tau_x, const double tau_lambda,
+                         const double x_pred, const double lambda_pred,
+                         const continuation_settings &settings, double &x, double &lambda) {
+    x = x_pred;
+    lambda = lambda_pred;
+    double H, H_x, H_lambda;
+
+    for (int i = 0; i < settings.max_corrector_iterations; i++) {
+        homotopy_residual(path, x, lambda, H, H_x, H_lambda);
+        const double g = tau_x * (x - x_pred) + tau_lambda * (lambda - lambda_pred);
+
+        // | H_x     H_lambda   | |dx     |   | H |
+        // | tau_x   tau_lambda | |dlambda| = | g |
+        const double det = H_x * tau_lambda - H_lambda * tau_x;
+        if (!std::isfinite(det) || fabs(det) < 1e-14) {
+            return -1;
+        }
+        const double dx = (H * tau_lambda - H_lambda * g) / det;
+        const double dlambda = (H_x * g - H * tau_x) / det;
+
+        x -= dx;
+        lambda -= dlambda;
+
+        if (fabs(dx) < settings.epsilon && fabs(dlambda) < settings.epsilon) {
+            METRICS_HISTOGRAM("task_1.continuation.corrector_iterations", i + 1);
+            METRICS_HISTOGRAM("task_1.continuation.residual", fabs(H));
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Единичная касательная к кривой H(x, lambda) = 0,
+ * сонаправленная с предыдущей касательной (prev_x, prev_lambda).
+*/
+inline void curve_tangent(const parameter_path &path, const double x, const double lambda,
+                          const double prev_x, const double prev_lambda,
+                          double &tau_x, double &tau_lambda) {
+    double H, H_x, H_lambda;
+    homotopy_residual(path, x, lambda, H, H_x, H_lambda);
+    const double norm = sqrt(H_x * H_x + H_lambda * H_lambda);
+    tau_x = -H_lambda / norm;
+    tau_lambda = H_x / norm;
+    if (tau_x * prev_x + tau_lambda * prev_lambda < 0) {
+        tau_x = -tau_x;
+        tau_lambda = -tau_lambda;
+    }
+}
+
+/**
+ * @brief Прослеживание одной ветви корней методом продолжения по длине дуги.
+ *
+ * @param path путь по параметрам.
+ * @param x0 корень при lambda = 0.
+ * @param settings настройки метода.
+ *
+ * Предиктор - шаг вдоль касательной, корректор - метод Ньютона,
+ * стартующий с предсказанной точки. Шаг увеличивается, если корректор
+ * сошелся быстро, и уменьшается вдвое при расхождении. Смена знака
+ * dlambda/ds отмечается как точка поворота: ветвь разворачивается и
+ * продолжается в обратную сторону по lambda.
+*/
+inline root_branch trace_branch(const parameter_path &path, const double x0,
+                                const continuation_settings &settings) {
+    root_branch branch;
+    branch.complete = false;
+
+    double x = x0;
+    double lambda = 0.0;
+    branch_point start = {lambda, x};
+    branch.points.push_back(start);
+
+    double tau_x, tau_lambda;
+    curve_tangent(path, x, lambda, 0.0, 1.0, tau_x, tau_lambda);
+
+    double h = settings.h0;
+    for (int step = 0; step < settings.max_steps; step++) {
+        double x_new, lambda_new;
+        const int iterations = correct_point(path, tau_x, tau_lambda,
+                                             x + h * tau_x, lambda + h * tau_lambda,
+                                             settings, x_new, lambda_new);
+        if (iterations < 0 || fabs(x_new - x) > 4 * h) {
+            METRICS_COUNT("task_1.continuation.rejected_steps");
+            h *= 0.5;
+            if (h < settings.h_min) {
+                return branch;
+            }
+            continue;
+        }
+
+        if (lambda_new > 1.0 || lambda_new < 0.0) {
+            // Последний шаг - точно на границу lambda, корректор по x при фиксированном lambda
+            const double lambda_end = (lambda_new > 1.0) ? 1.0 : 0.0;
+            double x_end = x + (x_new - x) * (lambda_end - lambda) / (lambda_new - lambda);
+            double H, H_x, H_lambda;
+            for (int i = 0; i < settings.max_corrector_iterations; i++) {
+                homotopy_residual(path, x_end, lambda_end, H, H_x, H_lambda);
+                if (fabs(H_x) < 1e-12) {
+                    break;
+                }
+                const double dx = H / H_x;
+                x_end -= dx;
+                if (fabs(dx) < settings.epsilon) {
+                    break;
+                }
+            }
+            branch_point end = {lambda_end, x_end};
+            branch.points.push_back(end);
+            branch.complete = true;
+            return branch;
+        }
+
+        double new_tau_x, new_tau_lambda;
+        curve_tangent(path, x_new, lambda_new, tau_x, tau_lambda, new_tau_x, new_tau_lambda);
+        if (new_tau_lambda * tau_lambda < 0) {
+            // Положение точки поворота - линейная интерполяция нуля dlambda/ds
+            const double s = tau_lambda / (tau_lambda - new_tau_lambda);
+            branch_point turn = {lambda + s * (lambda_new - lambda), x + s * (x_new - x)};
+            branch.turning_points.push_back(turn);
+        }
+
+        METRICS_COUNT("task_1.continuation.steps");
+        x = x_new;
+        lambda = lambda_new;
+        tau_x = new_tau_x;
+        tau_lambda = new_tau_lambda;
+        branch_point point = {lambda, x};
+        branch.points.push_back(point);
+
+        if (iterations <= 3) {
+            h = fmin(1.5 * h, settings.h_max);
+        } else if (iterations > 5) {
+            h = fmax(0.5 * h, settings.h_min);
+        }
+    }
+    return branch;
+}
+
+/**
+ * @brief Прослеживание всех ветвей, начинающихся в корнях при lambda = 0.
+ *
+ * Ветви, ушедшие через точку поворота обратно к lambda = 0, заканчиваются
+ * в другом стартовом корне; такой корень повторно не прослеживается.
+*/
+inline std::vector<root_branch> trace_all_branches(const parameter_path &path,
+                                                   const std::vector<double> &start_roots,
+                                                   const continuation_settings &settings) {
+    std::vector<root_branch> branches;
+    std::vector<bool> visited(start_roots.size(), false);
+
+    for (size_t i = 0; i < start_roots.size(); i++) {
+        if (visited[i]) {
+            continue;
+        }
+        visited[i] = true;
+        root_branch branch = trace_branch(path, start_roots[i], settings);
+
+        const branch_point &end = branch.points.back();
+        if (branch.complete && end.lambda == 0.0) {
+            for (size_t j = 0; j < start_roots.size(); j++) {
+                if (!visited[j] && fabs(start_roots[j] - end.x) < 1e-4) {
+                    visited[j] = true;
+                }
+            }
+        }
+        branches.push_back(branch);
+    }
+    return branches;
+}
+
+#endif
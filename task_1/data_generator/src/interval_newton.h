@@ -0,0 +1,290 @@
+#ifndef INTERVAL_NEWTON_H
+#define INTERVAL_NEWTON_H
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "metrics.h"
+
+/**
+ * @brief Замкнутый интервал [lo, hi] с внешним округлением границ.
+ *
+ * Все операции ниже сдвигают нижнюю границу вниз, а верхнюю вверх
+ * на одно машинное число, поэтому точное множество значений
+ * всегда лежит внутри вычисленного интервала.
+*/
+struct interval {
+    double lo;
+    double hi;
+};
+
+/**
+ * @brief Результат изоляции корня.
+ *
+ * x, y - включения координат корня системы.
+ * verified - true, если существование и единственность корня
+ * в x доказаны интервальным методом Ньютона.
+*/
+struct root_enclosure {
+    interval x;
+    interval y;
+    bool verified;
+};
+
+/**
+ * @brief Результат изоляции всех корней на отрезке.
+ *
+ * roots - включения корней по возрастанию x.
+ * complete - true, если все интервалы обработаны; false, если исчерпан
+ * лимит max_boxes и в необработанных интервалах могут остаться корни.
+*/
+struct root_isolation {
+    std::vector<root_enclosure> roots;
+    bool complete;
+};
+
+inline double round_down(const double v) {
+    return std::nextafter(v, -std::numeric_limits<double>::infinity());
+}
+
+inline double round_up(const double v) {
+    return std::nextafter(v, std::numeric_limits<double>::infinity());
+}
+
+inline interval make_interval(const double lo, const double hi) {
+    interval r = {lo, hi};
+    return r;
+}
+
+inline double width(const interval &a) {
+    return a.hi - a.lo;
+}
+
+inline double midpoint(const interval &a) {
+    return a.lo + 0.5 * (a.hi - a.lo);
+}
+
+inline bool contains_zero(const interval &a) {
+    return a.lo <= 0.0 && a.hi >= 0.0;
+}
+
+/**
+ * @brief Строгое включение a во внутренность b.
+*/
+inline bool strictly_inside(const interval &a, const interval &b) {
+    return a.lo > b.lo && a.hi < b.hi;
+}
+
+inline interval operator+(const interval &a, const interval &b) {
+    return make_interval(round_down(a.lo + b.lo), round_up(a.hi + b.hi));
+}
+
+inline interval operator-(const interval &a, const interval &b) {
+    return make_interval(round_down(a.lo - b.hi), round_up(a.hi - b.lo));
+}
+
+inline interval operator*(const interval &a, const interval &b) {
+    const double p[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+    double lo = p[0];
+    double hi = p[0];
+    for (int i = 1; i < 4; i++) {
+        lo = std::fmin(lo, p[i]);
+        hi = std::fmax(hi, p[i]);
+    }
+    return make_interval(round_down(lo), round_up(hi));
+}
+
+/**
+ * @brief Деление интервалов, знаменатель не должен содержать ноль.
+*/
+inline interval operator/(const interval &a, const interval &b) {
+    return a * make_interval(round_down(1.0 / b.hi), round_up(1.0 / b.lo));
+}
+
+/**
+ * @brief Квадрат интервала (в отличие от a * a не бывает отрицательным).
+*/
+inline interval sqr(const interval &a) {
+    const double l = std::fabs(a.lo);
+    const double h = std::fabs(a.hi);
+    if (contains_zero(a)) {
+        return make_interval(0.0, round_up(std::fmax(l, h) * std::fmax(l, h)));
+    }
+    const double m = std::fmin(l, h);
+    const double M = std::fmax(l, h);
+    return make_interval(std::fmax(0.0, round_down(m * m)), round_up(M * M));
+}
+
+/**
+ * @brief Проверка, может ли интервал содержать полюс тангенса pi/2 + k*pi.
+ *
+ * Проверка консервативная: интервал, близкий к полюсу, тоже считается
+ * содержащим его. Это лишь замедляет сходимость, но не теряет корни.
+*/
+inline bool may_contain_tan_pole(const interval &a) {
+    const double margin = 1e-12;
+    const double k_lo = std::floor((a.lo - M_PI_2) / M_PI - margin);
+    const double k_hi = std::floor((a.hi - M_PI_2) / M_PI + margin);
+    return k_lo != k_hi;
+}
+
+/**
+ * @brief Интервальный тангенс на интервале без полюсов.
+ *
+ * Тангенс монотонно возрастает на каждой ветви, поэтому достаточно
+ * значений на концах. Границы расширяются на два машинных числа,
+ * чтобы покрыть погрешность libm (не более 1 ulp).
+*/
+inline interval tan_no_pole(const interval &a) {
+    return make_interval(round_down(round_down(std::tan(a.lo))),
+                         round_up(round_up(std::tan(a.hi))));
+}
+
+/**
+ * @brief Включение tg^2(x) на интервале, в том числе с полюсом.
+ *
+ * Если интервал содержит полюс, tg^2 неограничен сверху, а снизу
+ * ограничен меньшим из значений на концах (при ширине меньше pi/2
+ * интервал не содержит нулей тангенса).
+*/
+inline interval tan_squared(const interval &a) {
+    const double inf = std::numeric_limits<double>::infinity();
+    if (!may_contain_tan_pole(a)) {
+        return sqr(tan_no_pole(a));
+    }
+    if (width(a) >= M_PI_2) {
+        return make_interval(0.0, inf);
+    }
+    const interval left = sqr(tan_no_pole(make_interval(a.lo, a.lo)));
+    const interval right = sqr(tan_no_pole(make_interval(a.hi, a.hi)));
+    return make_interval(std::fmin(left.lo, right.lo), inf);
+}
+
+/**
+ * @brief Интервальное расширение F(x) = x^2 + tg^2(x) - 1.
+*/
+inline interval system_function(const interval &x) {
+    return sqr(x) + tan_squared(x) - make_interval(1.0, 1.0);
+}
+
+/**
+ * @brief Интервальное расширение F'(x) = 2x + 2 tg(x) (1 + tg^2(x)).
+ *
+ * Используется тождество 1/cos^2(x) = 1 + tg^2(x). Интервал не должен
+ * содержать полюс тангенса.
+*/
+inline interval system_derivative(const interval &x) {
+    const interval two = make_interval(2.0, 2.0);
+    const interval one = make_interval(1.0, 1.0);
+    const interval t = tan_no_pole(x);
+    return two * x + two * t * (one + sqr(t));
+}
+
+/**
+ * @brief Изоляция всех корней системы x^2 + y^2 = 1, y = tg(x) на отрезке.
+ *
+ * @param a левая граница поиска по x.
+ * @param b правая граница поиска по x.
+ * @param tolerance требуемая ширина включения корня.
+ * @param max_boxes ограничение на число обработанных интервалов.
+ *
+ * Метод ветвей и границ с интервальным методом Ньютона:
+ * - интервал отбрасывается, если 0 не принадлежит F(X);
+ * - если 0 не принадлежит F'(X), выполняется шаг
+ *   N(X) = m - F(m) / F'(X) и X заменяется на N(X) ∩ X;
+ * - если N(X) лежит строго внутри X, корень в X существует и единственен;
+ * - иначе (полюс тангенса, 0 в F'(X), медленное сужение) интервал делится пополам.
+ *
+ * Включения шириной не больше tolerance упорядочиваются по x, соприкасающиеся
+ * недоказанные включения объединяются: корень точно в точке деления попадает
+ * в обе половины и иначе был бы выдан дважды. Доказанные включения не сливаются -
+ * их корень лежит строго внутри, поэтому сосед не может содержать тот же корень.
+ * Объединенное включение может быть шире tolerance.
+*/
+inline root_isolation isolate_roots(const double a, const double b,
+                                    const double tolerance, const int max_boxes) {
+    std::vector<root_enclosure> roots;
+    std::deque<interval> queue;
+    queue.push_back(make_interval(a, b));
+
+    int processed = 0;
+    while (!queue.empty() && processed < max_boxes) {
+        interval x = queue.front();
+        queue.pop_front();
+        processed++;
+        METRICS_COUNT("task_1.interval_newton.boxes");
+
+        if (!contains_zero(system_function(x))) {
+            continue;
+        }
+
+        bool verified = false;
+        bool empty = false;
+        while (!may_contain_tan_pole(x)) {
+            const interval dF = system_derivative(x);
+            if (contains_zero(dF)) {
+                break;
+            }
+
+            const double m = midpoint(x);
+            const interval n = make_interval(m, m) - system_function(make_interval(m, m)) / dF;
+            METRICS_COUNT("task_1.interval_newton.steps");
+            if (n.hi < x.lo || n.lo > x.hi) {
+                empty = true;
+                break;
+            }
+
+            verified = verified || strictly_inside(n, x);
+            const interval narrowed = make_interval(std::fmax(n.lo, x.lo), std::fmin(n.hi, x.hi));
+            const bool stalled = width(narrowed) > 0.5 * width(x);
+            x = narrowed;
+
+            if (width(x) <= tolerance || stalled) {
+                break;
+            }
+        }
+        if (empty) {
+            continue;
+        }
+
+        if (width(x) <= tolerance) {
+            if (!contains_zero(system_function(x))) {
+                continue;
+            }
+            root_enclosure root;
+            root.x = x;
+            root.y = may_contain_tan_pole(x) ? make_interval(-HUGE_VAL, HUGE_VAL) : tan_no_pole(x);
+            root.verified = verified;
+            roots.push_back(root);
+            continue;
+        }
+
+        METRICS_COUNT("task_1.interval_newton.bisections");
+        const double m = midpoint(x);
+        queue.push_back(make_interval(x.lo, m));
+        queue.push_back(make_interval(m, x.hi));
+    }
+
+    std::sort(roots.begin(), roots.end(), [](const root_enclosure &l, const root_enclosure &r) {
+        return l.x.lo < r.x.lo;
+    });
+    root_isolation result;
+    result.complete = queue.empty();
+    for (const root_enclosure &root: roots) {
+        if (!result.roots.empty()) {
+            root_enclosure &last = result.roots.back();
+            if (!last.verified && !root.verified && root.x.lo <= last.x.hi) {
+                last.x = make_interval(last.x.lo, std::fmax(last.x.hi, root.x.hi));
+                last.y = make_interval(std::fmin(last.y.lo, root.y.lo), std::fmax(last.y.hi, root.y.hi));
+                continue;
+            }
+        }
+        result.roots.push_back(root);
+    }
+    return result;
+}
+
+#endif
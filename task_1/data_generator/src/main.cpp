@@ -1,8 +1,19 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <cmath>
-#include <iomanip>
+#include <memory>
+
+#include "autodiff.h"
+#include "chebyshev.h"
+#include "columnar_writer.h"
+#include "continuation.h"
+#include "interval_newton.h"
+#include "metrics.h"
+#include "output_options.h"
+#include "sampling.h"
+#include "text_writer.h"
+
+namespace task_1 {
 
 /**
  * @brief Функция верхней полуокружности.
@@ -19,52 +30,30 @@ double circle_neg(double x) {
 }
 
 /**
- * @brief Функция производной от тангенса.
+ * @brief Функция F(x) = x² + tg²(x) - 1, корни которой дают решения системы.
+ *
+ * Корни ищутся сразу на всем отрезке по ее чебышевской аппроксимации
+ * (numerics::chebyshev_roots). Шаблон: с numerics::dual дает и производную.
 */
-double derivative(double x) {
-    return 1.0 / (cos(x) * cos(x));
+template <class T>
+T system_residual(const T &x) {
+    return x * x + tan(x) * tan(x) - 1.0;
 }
 
 /**
- * @brief Функция метод Ньютона.
- * @param x0 начальное приближение по x.
- * @param epsilon требуемая точность.
- * @param max_iterations максимальное число итераций.
+ * @brief Графический анализ системы, поиск корней и запись результатов.
  *
- * Решает систему методом Ньютона с матрицей Якоби.
- * Возвращает уточненное значение x.
+ * @param options какие файлы писать и в какой каталог.
 */
-double newton_method(const double x0, const double epsilon, const int max_iterations) {
-    double x = x0;
-
-    for (int i = 0; i < max_iterations; i++) {
-        double f = x * x + tan(x) * tan(x) - 1; // F(x) = x² + tg²(x) - 1
-        double df = 2 * x + 2 * tan(x) / (cos(x) * cos(x)); // F'(x)
-
-        if (fabs(df) < 1e-12) {
-            break;
-        }
-
-        double x_new = x - f / df;
-
-        if (fabs(x_new - x) < epsilon) {
-            return x_new;
-        }
-
-        x = x_new;
+int run(const output_options &options) {
+    METRICS_TIMER("task_1.run");
+    text_writer outfile;
+    if (options.text) {
+        outfile.open(options.path("results.txt"));
     }
 
-    return x;
-}
-
-int main() {
-    std::ofstream outfile("data/results.txt");
-    outfile << std::fixed << std::setprecision(8);
-
     double x_min = -2.0;
     double x_max = 2.0;
-    int points = 1000;
-    double step = (x_max - x_min) / points;
 
     std::vector<double> roots;
 
@@ -76,57 +65,127 @@ int main() {
     outfile << "ДАННЫЕ ДЛЯ ГРАФИКА:\n";
     outfile << "x\tcircle_upper\tcircle_lower\ttan\n";
 
-    for (int i = 0; i <= points; i++) {
-        double x = x_min + i * step;
-        double tan_val;
-        if (fabs(cos(x)) < 1e-10) {
-            tan_val = NAN;
-        } else {
-            tan_val = tan(x);
-        }
-
-        double circle_up = (fabs(x) <= 1.0) ? circle(x) : NAN;
-        double circle_low = (fabs(x) <= 1.0) ? circle_neg(x) : NAN;
-
-        outfile << x << "\t" << circle_up << "\t" << circle_low << "\t" << tan_val << std::endl;
+    std::unique_ptr<columnar::writer> graph;
+    if (options.binary) {
+        graph.reset(new columnar::writer(options.path("graph.bin"), {"x", "circle_upper", "circle_lower", "tan"}));
     }
 
-    outfile << std::endl;
+    // Адаптивная выборка в окне плоттера y in [-1.5, 1.5]: у полюсов tg x точки
+    // сгущаются до уровня разрешения, вне окна и на прямых участках их мало.
+    // На полюсе tan = NaN, вне |x| <= 1 окружность не определена (NaN).
+    const std::vector<numerics::view_range> window(3, numerics::view_range{-1.5, 1.5});
+    const numerics::sampled_curve curve = numerics::adaptive_sample([](double x, double *y) {
+        y[0] = (fabs(x) <= 1.0) ? circle(x) : NAN;
+        y[1] = (fabs(x) <= 1.0) ? circle_neg(x) : NAN;
+        y[2] = tan(x);
+    }, 3, x_min, x_max, window);
+
+    for (std::size_t i = 0; i < curve.size(); i++) {
+        const double *y = &curve.y[3 * i];
+        outfile << curve.x[i] << "\t" << y[0] << "\t" << y[1] << "\t" << y[2] << "\n";
+        if (graph) {
+            const double row[4] = {curve.x[i], y[0], y[1], y[2]};
+            graph->append(row);
+        }
+    }
+    if (graph) {
+        graph->close();
+    }
 
-    outfile << "ПРИБЛИЖЕННЫЕ КОРНИ:" << std::endl;
+    outfile << "\n";
 
-    std::vector<double> initial_guesses = {-1.2, -0.6, 0.0, 0.6, 1.2};
+    outfile << "ПРИБЛИЖЕННЫЕ КОРНИ:" << "\n";
 
-    for (double guess: initial_guesses) {
-        double epsilon = 1e-6;
-        double root = newton_method(guess, epsilon, 100);
+    // Все корни F на [x_min, x_max] сразу - без подбора начальных приближений:
+    // куски около полюсов tg x отсекаются адаптивным делением, корни уточняются
+    // шагом Ньютона по производной F из автоматического дифференцирования
+    const double epsilon = 1e-6;
+    const numerics::scalar_function F = [](double x) { return system_residual(x); };
+    const numerics::scalar_function dF = [](double x) {
+        double value;
+        return numerics::derivative([](const auto &t) { return system_residual(t); }, x, value);
+    };
+    for (double root: numerics::chebyshev_roots(F, dF, x_min, x_max)) {
         double y_root = tan(root);
 
         // Проверяем, что точка лежит на окружности
         if (fabs(root * root + y_root * y_root - 1) < epsilon) {
-            bool is_duplicate = false;
-            for (double existing_root: roots) {
-                if (fabs(root - existing_root) < 0.1) {
-                    is_duplicate = true;
-                    break;
-                }
-            }
-
-            if (!is_duplicate) {
-                roots.push_back(root);
-                outfile << "Корень: x = " << root << ", y = " << y_root << std::endl;
-                outfile << "Проверка: x^2 + y^2 = " << root * root + y_root * y_root << std::endl;
-            }
+            roots.push_back(root);
+            outfile << "Корень: x = " << root << ", y = " << y_root << "\n";
+            outfile << "Проверка: x^2 + y^2 = " << root * root + y_root * y_root << "\n";
         }
     }
 
-    outfile << std::endl;
-    outfile << "ВСЕ НАЙДЕННЫЕ КОРНИ:" << std::endl;
+    outfile << "\n";
+    outfile << "ГАРАНТИРОВАННЫЕ ВКЛЮЧЕНИЯ КОРНЕЙ (интервальный метод Ньютона):" << "\n";
+
+    const root_isolation isolation = isolate_roots(x_min, x_max, 1e-6, 100000);
+
+    for (const root_enclosure &e: isolation.roots) {
+        outfile << "Включение: x in [" << e.x.lo << ", " << e.x.hi << "], y in ["
+                << e.y.lo << ", " << e.y.hi << "], ширина = " << width(e.x)
+                << (e.verified ? ", корень доказан" : ", корень не доказан") << "\n";
+    }
+    if (!isolation.complete) {
+        outfile << "Исчерпан лимит интервалов: список включений может быть неполным" << "\n";
+    }
+
+    outfile << "\n";
+    outfile << "ВСЕ НАЙДЕННЫЕ КОРНИ:" << "\n";
     for (size_t i = 0; i < roots.size(); i++) {
         double y = tan(roots[i]);
-        outfile << "Корень " << i + 1 << ": (" << roots[i] << ", " << y << ")" << std::endl;
+        outfile << "Корень " << i + 1 << ": (" << roots[i] << ", " << y << ")" << "\n";
+    }
+
+    // Семейство x^2 + y^2 = r^2, y = tg(kx): ветви корней при уменьшении r от 4 до 1
+    parameter_path path = {{4.0, 1.0}, {1.0, 1.0}};
+    continuation_settings settings = {1e-2, 1e-8, 5e-2, 1e-10, 10, 100000};
+
+    std::vector<double> start_roots = find_start_roots(path, 0.0, -5.0, 5.0, 2000, 1e-12);
+    std::vector<root_branch> branches = trace_all_branches(path, start_roots, settings);
+
+    outfile << "\n";
+    outfile << "ПРОДОЛЖЕНИЕ ПО ПАРАМЕТРУ (r от " << path.from.r << " до " << path.to.r
+            << ", k = " << path.from.k << "):" << "\n";
+    for (size_t i = 0; i < branches.size(); i++) {
+        const root_branch &branch = branches[i];
+        const branch_point &begin = branch.points.front();
+        const branch_point &end = branch.points.back();
+        outfile << "Ветвь " << i + 1 << ": x = " << begin.x << " при r = " << path.at(begin.lambda).r
+                << " -> x = " << end.x << " при r = " << path.at(end.lambda).r
+                << ", шагов: " << branch.points.size() - 1
+                << (branch.complete ? "" : ", ветвь прервана") << "\n";
+        for (const branch_point &turn: branch.turning_points) {
+            outfile << "Точка поворота: x = " << turn.x << ", r = " << path.at(turn.lambda).r << "\n";
+        }
     }
 
     outfile.close();
+
+    if (options.binary) {
+        columnar::writer roots_table(options.path("roots.bin"), {"x", "y"});
+        roots_table.set_attribute("root_count", static_cast<double>(roots.size()));
+        for (double root: roots) {
+            const double row[2] = {root, tan(root)};
+            roots_table.append(row);
+        }
+        roots_table.close();
+
+        columnar::writer enclosures_table(options.path("enclosures.bin"), {"x_lo", "x_hi", "y_lo", "y_hi", "verified"});
+        enclosures_table.set_attribute("complete", isolation.complete ? 1.0 : 0.0);
+        for (const root_enclosure &e: isolation.roots) {
+            const double row[5] = {e.x.lo, e.x.hi, e.y.lo, e.y.hi, e.verified ? 1.0 : 0.0};
+            enclosures_table.append(row);
+        }
+        enclosures_table.close();
+    }
     return 0;
 }
+
+} // namespace task_1
+
+#ifndef DATA_GENERATOR_NO_MAIN
+int main(int argc, char **argv) {
+    return task_1::run(parse_output_options(argc, argv));
+}
+#endif
@@ -1,8 +1,19 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
-#include <fstream>
 #include <iomanip>
+#include <memory>
+
+#include "columnar_writer.h"
+#include "cubature.h"
+#include "metrics.h"
+#include "output_options.h"
+#include "quadrature.h"
+#include "result_cache.h"
+#include "sampling.h"
+#include "text_writer.h"
+
+namespace task_2 {
 
 /**
  * @brief Подынтегральная функция f(x) = sin(100x) * exp(-x^2) * cos(2x).
@@ -15,253 +26,156 @@ double f(double const x) {
 }
 
 /**
- * @brief Функция метода средних прямоугольников.
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @param n Количество разбиений отрезка [a,b].
- * @return Приближенное значение интеграла.
- *
- * Алгоритм:
- * - Разбивает отрезок [a,b] на n равных частей.
- * - В каждом подинтервале вычисляет значение функции в средней точке.
- * - Суммирует площади прямоугольников.
- *
- * h - шаг разбиения, h = (b - a) / n.
- * sum - накопленная сумма площадей прямоугольников.
- * x - середина текущего подинтервала.
+ * @brief Пакетная версия f для квадратур библиотеки numerics: y[i] = f(x[i]).
  */
-double rectangle_method(double const a, double const b, int const n) {
-    double h = (b - a) / n;
-    double sum = 0.0;
-
-    for (int i = 0; i < n; i++) {
-        double x = a + (i + 0.5) * h;
-        sum += f(x);
+void f_batch(const double *x, double *y, std::size_t n) {
+    METRICS_ADD("task_2.f_evaluations", n);
+    for (std::size_t i = 0; i < n; i++) {
+        y[i] = f(x[i]);
     }
-
-    return sum * h;
 }
 
 /**
- * @brief Функция метода трапеций.
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @param n Количество разбиений отрезка [a,b].
- * @return Приближенное значение интеграла.
- *
- * Алгоритм:
- * - Разбивает отрезок [a,b] на n равных частей.
- * - В каждом подинтервале аппроксимирует функцию линейно.
- * - Суммирует площади трапеций.
- *
- * h - шаг разбиения.
- * sum - сумма с весами (начало и конец с весом 0.5, остальные с весом 1).
- * x - текущая точка на отрезке интегрирования.
+ * @brief Имя подынтегральной функции в ключах кэша (смену f ловит и отпечаток сборки).
  */
-double trapezoidal_method(double const a, double const b, int const n) {
-    double h = (b - a) / n;
-    double sum = 0.5 * (f(a) + f(b));
+const char *const integrand_name = "sin(100x)*exp(-x^2)*cos(2x)";
 
-    for (int i = 1; i < n; i++) {
-        double x = a + i * h;
-        sum += f(x);
-    }
-
-    return sum * h;
-}
+typedef double (*quadrature)(const numerics::batch_function &f, double a, double b, int n);
 
 /**
- * @brief Функция метода Симпсона.
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @param n Количество разбиений отрезка [a,b].
- * @return Приближенное значение интеграла.
+ * @brief Метод в сравнении квадратур.
  *
- * Алгоритм:
- * - Разбивает отрезок [a,b] на n равных частей (n четное).
- * - На каждой паре подинтервалов аппроксимирует функцию параболой.
- * - Использует веса 1-4-2-4-2-...-4-1.
- *
- * h - шаг разбиения.
- * sum - сумма с весами Симпсона.
- * x - текущая точка разбиения.
+ * name - имя в ключе кэша и атрибут в convergence.bin, title - подпись в результатах,
+ * n - число разбиений (для квадратур Гаусса - число узлов).
  */
-double simpson_method(double const a, double const b, int n) {
-    if (n % 2 != 0) n++;
-    double h = (b - a) / n;
-    double sum = f(a) + f(b);
-
-    for (int i = 1; i < n; i++) {
-        double x = a + i * h;
-        if (i % 2 == 0) {
-            sum += 2.0 * f(x);
-        } else {
-            sum += 4.0 * f(x);
-        }
-    }
-    return sum * h / 3.0;
-}
+struct quadrature_entry {
+    const char *name;
+    const char *title;
+    quadrature method;
+    int n;
+};
 
 /**
- * @brief Функция правила 3/8.
+ * @brief Интеграл f по [a,b] методом method с параметром n через кэш результатов.
  *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @param n Количество разбиений отрезка [a,b].
- * @return Приближенное значение интеграла.
- *
- * Алгоритм:
- * - Разбивает отрезок [a,b] на n равных частей (n кратно 3).
- * - На каждой тройке подинтервалов использует кубическую аппроксимацию.
- * - Использует веса 1-3-3-2-3-3-2-...-3-3-1.
- *
- * h - шаг разбиения
- * sum - сумма с весами правила 3/8
- * x - текущая точка разбиения
+ * @param method_name имя метода в ключе кэша.
+ * @param n число разбиений (для квадратур Гаусса - число узлов).
  */
-double three_eights_method(double const a, double const b, int n) {
-    if (n % 3 != 0) n += (3 - n % 3);
-    double h = (b - a) / n;
-    double sum = f(a) + f(b);
-
-    for (int i = 1; i < n; i++) {
-        double x = a + i * h;
-        if (i % 3 == 0) {
-            sum += 2.0 * f(x);
-        } else {
-            sum += 3.0 * f(x);
-        }
-    }
-    return sum * h * 3.0 / 8.0;
+double cached_integral(memo::cache &cache, const char *method_name, quadrature method,
+                       double const a, double const b, int const n) {
+    METRICS_TIMER("task_2.integral");
+    const memo::key key = memo::key("task_2.integral").add(integrand_name).add(method_name).add(a).add(b).add(n);
+    return cache.get_or_compute(key, [&]() {
+        return std::vector<double>(1, method(f_batch, a, b, n));
+    })[0];
 }
 
 /**
- * @brief Функция квадратуры Гаусса с 2 узлами (степень 3).
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @return Приближенное значение интеграла.
+ * @brief Многомерная подынтегральная функция g(x) = cos(x_1 + ... + x_d) * exp(-|x|^2).
  *
- * Алгоритм:
- * - Использует 2 оптимально расположенных узла на [-1,1].
- * - Линейное преобразование на отрезок [a,b].
- *
- * nodes[2] - узлы на стандартном отрезке [-1,1].
- * weights[2] - веса квадратурной формулы.
- * scale - масштабный коэффициент для преобразования отрезка.
- * shift - сдвиг для преобразования отрезка.
- * x - преобразованная точка на [a,b].
+ * Пакетная форма для кубатур numerics: points - count точек по dim координат.
+ * Не имеет состояния, поэтому безопасна для параллельного вызова.
  */
-double gauss_2_nodes(double const a, double const b) {
-    const double nodes[2] = {-1.0 / sqrt(3.0), 1.0 / sqrt(3.0)};
-    const double weights[2] = {1.0, 1.0};
-
-    double sum = 0.0;
-    double scale = (b - a) / 2.0;
-    double shift = (a + b) / 2.0;
-
-    for (int i = 0; i < 2; i++) {
-        double x = shift + scale * nodes[i];
-        sum += weights[i] * f(x);
+void g_batch(const double *points, double *values, std::size_t count, int const dim) {
+    METRICS_ADD("task_2.g_evaluations", count);
+    for (std::size_t i = 0; i < count; i++) {
+        const double *x = points + i * dim;
+        double sum = 0.0, norm2 = 0.0;
+        for (int k = 0; k < dim; k++) {
+            sum += x[k];
+            norm2 += x[k] * x[k];
+        }
+        values[i] = cos(sum) * exp(-norm2);
     }
-    return sum * scale;
 }
 
 /**
- * @brief Функция квадратуры Гаусса с 3 узлами (степень 5).
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @return Приближенное значение интеграла.
- *
- * Алгоритм:
- * - Использует 3 оптимально расположенных узла на [-1,1].
- * - Узлы: корни многочлена Лежандра 3-й степени.
- *
- * nodes[3] - узлы Гаусса на [-1,1].
- * weights[3] - соответствующие веса.
- * scale, shift - параметры преобразования отрезка.
+ * @brief Точное значение int_[0,1]^d g: g = Re prod_k exp(-x_k^2 + i x_k), так что
+ * интеграл равен Re z^d, z = int_0^1 exp(-x^2) (cos x + i sin x) dx.
  */
-double gauss_3_nodes(double const a, double const b) {
-    const double nodes[3] = {-sqrt(3.0 / 5.0), 0.0, sqrt(3.0 / 5.0)};
-    const double weights[3] = {5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0};
-
-    double sum = 0.0;
-    double scale = (b - a) / 2.0;
-    double shift = (a + b) / 2.0;
-
-    for (int i = 0; i < 3; i++) {
-        double x = shift + scale * nodes[i];
-        sum += weights[i] * f(x);
+double g_reference(int const dim) {
+    const double re = numerics::simpson_method([](const double *x, double *y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            y[i] = exp(-x[i] * x[i]) * cos(x[i]);
+        }
+    }, 0.0, 1.0, 20000);
+    const double im = numerics::simpson_method([](const double *x, double *y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            y[i] = exp(-x[i] * x[i]) * sin(x[i]);
+        }
+    }, 0.0, 1.0, 20000);
+    double r_re = 1.0, r_im = 0.0;
+    for (int k = 0; k < dim; k++) {
+        const double t = r_re * re - r_im * im;
+        r_im = r_re * im + r_im * re;
+        r_re = t;
     }
-    return sum * scale;
+    return r_re;
 }
 
 /**
- * @brief Функция квадратуры Гаусса с 4 узлами (степень 7).
- *
- * @param a Нижний предел интегрирования.
- * @param b Верхний предел интегрирования.
- * @return Приближенное значение интеграла.
- *
- * Алгоритм:
- * - Использует 4 оптимально расположенных узла на [-1,1].
- * - Узлы: корни многочлена Лежандра 4-й степени.
+ * @brief Сравнение кубатур на [0,1]^d для d = 2..10: тензорный Гаусс (d <= 4),
+ * сетка Смоляка и рандомизированный квази-Монте-Карло Соболя.
  *
- * nodes[4] - узлы Гаусса 4-го порядка.
- * weights[4] - соответствующие веса.
- * scale, shift - параметры линейного преобразования.
+ * Результаты пишутся в cubature_results.txt и cubature.bin, results.txt
+ * не меняется (его читает плоттер).
  */
-double gauss_4_nodes(double const a, double const b) {
-    const double nodes[4] = {
-        -sqrt(3.0 / 7.0 + 2.0 / 7.0 * sqrt(6.0 / 5.0)),
-        -sqrt(3.0 / 7.0 - 2.0 / 7.0 * sqrt(6.0 / 5.0)),
-        sqrt(3.0 / 7.0 - 2.0 / 7.0 * sqrt(6.0 / 5.0)),
-        sqrt(3.0 / 7.0 + 2.0 / 7.0 * sqrt(6.0 / 5.0))
-    };
-    const double weights[4] = {
-        (18.0 - sqrt(30.0)) / 36.0,
-        (18.0 + sqrt(30.0)) / 36.0,
-        (18.0 + sqrt(30.0)) / 36.0,
-        (18.0 - sqrt(30.0)) / 36.0
-    };
+void cubature_study(const output_options &options) {
+    METRICS_TIMER("task_2.cubature");
+    const int tensor_nodes = 8, smolyak_level = 5, qmc_replicates = 8;
+    const std::size_t qmc_points = 1 << 14;
+
+    text_writer file;
+    if (options.text) {
+        file.open(options.path("cubature_results.txt"));
+    }
+    std::unique_ptr<columnar::writer> table;
+    if (options.binary) {
+        table.reset(new columnar::writer(options.path("cubature.bin"),
+                                         {"d", "tensor_gauss", "smolyak", "sobol_qmc", "sobol_qmc_error", "reference"}));
+    }
 
-    double sum = 0.0;
-    double scale = (b - a) / 2.0;
-    double shift = (a + b) / 2.0;
+    std::cout << "\nМНОГОМЕРНЫЕ КУБАТУРЫ: int_[0,1]^d cos(x_1 + ... + x_d) * exp(-|x|²) dx\n";
+    std::cout << "Гаусс " << tensor_nodes << "^d узлов, Смоляк уровня " << smolyak_level
+            << ", Соболь " << qmc_replicates << " x " << qmc_points << " точек\n";
+    std::cout << "d\tТочное\t\tГаусс\t\tСмоляк\t\tСоболь\t\tОценка ошибки\n";
+    file << "МНОГОМЕРНЫЕ КУБАТУРЫ: int_[0,1]^d cos(x_1 + ... + x_d) * exp(-|x|²) dx\n";
+    file << "d\tТочное\t\tГаусс\t\tСмоляк\t\tСоболь\t\tОценка ошибки\n";
+
+    for (int dim = 2; dim <= 10; dim++) {
+        const numerics::batch_field g = [dim](const double *points, double *values, std::size_t count) {
+            g_batch(points, values, count, dim);
+        };
+        const std::vector<double> a(dim, 0.0), b(dim, 1.0);
+
+        const double reference = g_reference(dim);
+        const double tensor = (dim <= 4) ? numerics::tensor_gauss(g, a, b, tensor_nodes) : NAN;
+        const double sparse = numerics::smolyak(g, a, b, smolyak_level);
+        const numerics::qmc_estimate qmc = numerics::sobol_qmc(g, a, b, qmc_points, qmc_replicates, 2024);
+
+        std::cout << dim << "\t" << std::scientific << reference << "\t" << tensor << "\t" << sparse
+                << "\t" << qmc.value << "\t" << qmc.error << "\n";
+        file << dim << "\t" << reference << "\t" << tensor << "\t" << sparse
+                << "\t" << qmc.value << "\t" << qmc.error << "\n";
+        if (table) {
+            const double row[6] = {static_cast<double>(dim), tensor, sparse, qmc.value, qmc.error, reference};
+            table->append(row);
+        }
+    }
 
-    for (int i = 0; i < 4; i++) {
-        double x = shift + scale * nodes[i];
-        sum += weights[i] * f(x);
+    file.close();
+    if (table) {
+        table->close();
     }
-    return sum * scale;
 }
 
 /**
- * @brief Функция правила Рунге для оценки погрешности
- *
- * @param I_h Значение интеграла на сетке с шагом h.
- * @param I_h2 Значение интеграла на сетке с шагом h/2.
- * @param p Порядок точности метода.
- * @return Оценка погрешности по правилу Рунге.
- *
- * Формула:
- * e = |I_h - I_h2| / (2^p - 1).
+ * @brief Вычисление интеграла всеми методами и запись результатов.
  *
- * где:
- * I_h - приближение на грубой сетке.
- * I_h2 - приближение на мелкой сетке.
- * p - порядок метода (для Симпсона p=4, для трапеций p=2, etc.).
- * e - оценка погрешности приближения I_h2.
- */
-double runge_error(const double I_h, const double I_h2, const int p) {
-    return fabs(I_h - I_h2) / (pow(2, p) - 1);
-}
-
-int main() {
+ * @param options какие файлы писать и в какой каталог.
+*/
+int run(const output_options &options) {
+    METRICS_TIMER("task_2.run");
     std::cout << "ВЫЧИСЛЕНИЕ ИНТЕГРАЛА БЫСТРООСЦИЛЛИРУЮЩЕЙ ФУНКЦИИ\n";
     std::cout << "I = int_0^3 sin(100x) * exp(-x²) * cos(2x) dx\n";
     std::cout << "=============================================\n\n";
@@ -269,9 +183,16 @@ int main() {
     const double a = 0.0, b = 3.0;
     const int n_base = 100000; // Базовое количество разбиений
 
+    memo::cache cache;
+    if (options.cache) {
+        cache.open(options.path("cache.bin"));
+    }
+
     // Сохранение данных для графика
-    std::ofstream file("data/results.txt");
-    file << std::fixed << std::setprecision(12);
+    text_writer file;
+    if (options.text) {
+        file.open(options.path("results.txt"));
+    }
 
     file << "ИНТЕГРАЛ БЫСТРООСЦИЛЛИРУЮЩЕЙ ФУНКЦИИ\n";
     file << "I = int_0^3 sin(100x) * exp(-x²) * cos(2x) dx\n\n";
@@ -279,16 +200,21 @@ int main() {
     file << "СРАВНЕНИЕ МЕТОДОВ ЧИСЛЕННОГО ИНТЕГРИРОВАНИЯ\n";
     file << "===========================================\n";
 
-    std::vector<std::pair<std::string, double> > results;
-
-    results.push_back({"Метод средних прямоугольников", rectangle_method(a, b, n_base)});
-    results.push_back({"Метод трапеций", trapezoidal_method(a, b, n_base)});
-    results.push_back({"Метод Симпсона", simpson_method(a, b, n_base)});
-    results.push_back({"Правило 3/8", three_eights_method(a, b, n_base)});
+    const quadrature_entry methods[] = {
+        {"rectangle", "Метод средних прямоугольников", numerics::rectangle_method, n_base},
+        {"trapezoidal", "Метод трапеций", numerics::trapezoidal_method, n_base},
+        {"simpson", "Метод Симпсона", numerics::simpson_method, n_base},
+        {"three_eighths", "Правило 3/8", numerics::three_eights_method, n_base},
+        {"gauss_2", "Гаусс 2 узла", numerics::gauss_legendre, 2},
+        {"gauss_3", "Гаусс 3 узла", numerics::gauss_legendre, 3},
+        {"gauss_4", "Гаусс 4 узла", numerics::gauss_legendre, 4},
+    };
+    const quadrature_entry &simpson = methods[2];
 
-    results.push_back({"Гаусс 2 узла", gauss_2_nodes(a, b)});
-    results.push_back({"Гаусс 3 узла", gauss_3_nodes(a, b)});
-    results.push_back({"Гаусс 4 узла", gauss_4_nodes(a, b)});
+    std::vector<std::pair<std::string, double> > results;
+    for (const quadrature_entry &m: methods) {
+        results.push_back({m.title, cached_integral(cache, m.name, m.method, a, b, m.n)});
+    }
 
     std::cout << "РЕЗУЛЬТАТЫ ВЫЧИСЛЕНИЙ:\n";
     std::cout << "======================\n";
@@ -296,8 +222,7 @@ int main() {
     for (const auto &result: results) {
         std::cout << std::setw(25) << std::left << result.first << ": "
                 << std::scientific << result.second << "\n";
-        file << std::setw(25) << std::left << result.first << ": "
-                << std::scientific << result.second << "\n";
+        file << pad_right(result.first, 25) << ": " << result.second << "\n";
     }
 
     file << "\nАНАЛИЗ СХОДИМОСТИ МЕТОДА СИМПСОНА:\n";
@@ -306,13 +231,25 @@ int main() {
     std::cout << "\nАНАЛИЗ СХОДИМОСТИ МЕТОДА СИМПСОНА:\n";
     std::cout << "N\t\tI_h\t\t\t\tПогрешность (правило Рунге)\n";
 
+    std::unique_ptr<columnar::writer> convergence;
+    if (options.binary) {
+        convergence.reset(new columnar::writer(options.path("convergence.bin"), {"n", "I_h", "runge_error"}));
+        for (size_t i = 0; i < results.size(); i++) {
+            convergence->set_attribute(methods[i].name, results[i].second);
+        }
+    }
+
     double I_prev = 0;
     for (int n = 1000; n <= 100000; n *= 2) {
-        double I_current = simpson_method(a, b, n);
-        double error = (n > 1000) ? runge_error(I_prev, I_current, 4) : 0;
+        double I_current = cached_integral(cache, simpson.name, simpson.method, a, b, n);
+        double error = (n > 1000) ? numerics::runge_error(I_prev, I_current, 4) : 0;
 
         file << n << "\t\t" << I_current << "\t\t" << error << "\n";
         std::cout << n << "\t\t" << I_current << "\t\t" << error << "\n";
+        if (convergence) {
+            const double row[3] = {static_cast<double>(n), I_current, error};
+            convergence->append(row);
+        }
 
         I_prev = I_current;
     }
@@ -320,13 +257,42 @@ int main() {
     file << "\nДАННЫЕ ДЛЯ ГРАФИКА ФУНКЦИИ:\n";
     file << "x\t\tf(x)\n";
 
-    int plot_points = 1000;
-    for (int i = 0; i <= plot_points; i++) {
-        double x = a + (b - a) * i / plot_points;
-        file << x << "\t\t" << f(x) << "\n";
+    if (convergence) {
+        convergence->close();
+    }
+
+    std::unique_ptr<columnar::writer> function;
+    if (options.binary) {
+        function.reset(new columnar::writer(options.path("function.bin"), {"x", "f"}));
+    }
+
+    // Адаптивная выборка: точки сгущаются на вершинах колебаний и редеют там,
+    // где exp(-x²) гасит амплитуду. Начальная сетка - около 10 точек на период sin(100x).
+    numerics::sampling_settings sampling = numerics::default_sampling_settings;
+    sampling.initial_intervals = 512;
+    const numerics::sampled_curve curve = numerics::adaptive_sample([](double x, double *y) {
+        y[0] = f(x);
+    }, 1, a, b, {}, sampling);
+    // Текст для плоттера - не больше max_plot_points точек, в function.bin - вся выборка
+    const std::size_t max_plot_points = 2000;
+    const numerics::sampled_curve plot = numerics::lttb_decimate(curve, max_plot_points);
+
+    for (std::size_t i = 0; i < plot.size(); i++) {
+        file << plot.x[i] << "\t\t" << plot.y[i] << "\n";
+    }
+    if (function) {
+        for (std::size_t i = 0; i < curve.size(); i++) {
+            const double row[2] = {curve.x[i], curve.y[i]};
+            function->append(row);
+        }
     }
 
     file.close();
+    if (function) {
+        function->close();
+    }
+
+    cubature_study(options);
 
     std::cout << "\n=============================================\n";
     std::cout << "Результаты сохранены в файл: data/results.txt\n";
@@ -334,3 +300,11 @@ int main() {
 
     return 0;
 }
+
+} // namespace task_2
+
+#ifndef DATA_GENERATOR_NO_MAIN
+int main(int argc, char **argv) {
+    return task_2::run(parse_output_options(argc, argv));
+}
+#endif